@@ -0,0 +1,67 @@
+//bench_pre_trade_check.cpp
+//
+//This file contains a microbenchmark for the pre-trade check of the State class.
+//It measures the latency of rejected NewOrders (which run the check and nothing
+//else) against instruments with increasingly deep books, to show that the check
+//does not depend on the number of open orders. Every depth is measured with
+//the position check alone and with the full default set of checks enabled, to
+//show what the extra checks cost.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "state.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr int64_t THRESHOLD = 1'000'000'000;
+constexpr int CHECKS = 1'000'000;
+
+//Prevents the compiler from discarding the results
+volatile uint64_t sink;
+
+//Every limit is loose enough that only the position check rejects
+const RiskLimits LIMITS = {THRESHOLD, THRESHOLD, 2 * THRESHOLD, UINT64_MAX, 10000};
+
+template <typename Checks>
+double measure_check_ns(size_t book_depth) {
+    BasicState<Checks> state(LIMITS, book_depth + 1);
+    for (size_t i = 0; i < book_depth; ++i) {
+        state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, i + 1, 1, 100, 'B'});
+    }
+
+    //Always over the threshold, so each call is a pure check that leaves the state untouched
+    NewOrder order = {NewOrder::MESSAGE_TYPE, 1, book_depth + 1, THRESHOLD, 100, 'B'};
+    uint64_t accepted = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CHECKS; ++i) {
+        accepted += state.add_order_if_accepted(order);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    sink = accepted;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / CHECKS;
+}
+
+}
+
+int main() {
+    const std::vector<size_t> depths = {1, 100, 10'000, 100'000, 500'000};
+
+    std::cout << "Open orders\tns/check (position)\tns/check (all checks)\n";
+    double baseline = 0;
+    for (size_t depth : depths) {
+        double ns = measure_check_ns<DefaultRiskChecks>(depth);
+        if (depth == depths.front()) {
+            baseline = ns;
+        }
+        std::cout << depth << "\t\t" << measure_check_ns<PositionRiskChecks>(depth) << "\t\t\t" << ns << "\n";
+    }
+    std::cout << "Deepest book costs " << measure_check_ns<DefaultRiskChecks>(depths.back()) / baseline
+              << "x the single-order book\n";
+    return 0;
+}
@@ -0,0 +1,339 @@
+//risk_bench.cpp
+//
+//This file contains the RiskBench microbenchmark for the core State operations:
+//add_order_if_accepted, delete_order, modify_order_if_accepted and process_trade.
+//
+//Every operation is timed over a grid of instrument counts, resting book depths
+//(orders per instrument) and order ID distributions. Sequential IDs count up from
+//1 and are touched in order; random IDs are sparse 64-bit values touched in a
+//shuffled order, which defeats any locality in the order index. Results are
+//written to stdout as JSON with ns/op, ops/s and heap allocations per operation,
+//so runs can be diffed or fed to a regression check.
+//
+//Usage: RiskBench [--instruments 1,64,1024] [--depths 1,64,512]
+//                 [--ids sequential,random] [--ops 100000]
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//Counts every global allocation so the benchmark can report allocations per operation
+uint64_t allocations = 0;
+
+}
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+//Large enough that no benchmarked order is rejected by the thresholds
+constexpr int64_t THRESHOLD = 1'000'000'000'000;
+
+enum class IdDistribution { SEQUENTIAL, RANDOM };
+
+struct BenchConfig {
+    std::vector<size_t> instruments = {1, 64, 1024};
+    std::vector<size_t> depths = {1, 64, 512};
+    std::vector<IdDistribution> distributions = {IdDistribution::SEQUENTIAL, IdDistribution::RANDOM};
+    size_t ops = 100'000;
+};
+
+struct Result {
+    const char* operation;
+    size_t instruments;
+    size_t depth;
+    IdDistribution distribution;
+    size_t ops;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+//Prevents the compiler from discarding the results
+volatile uint64_t sink;
+
+//Order IDs and the order in which the benchmark touches them
+class Workload {
+public:
+    Workload(size_t instruments, size_t depth, size_t ops, IdDistribution distribution)
+        : instruments_(instruments), book_size_(instruments * depth), ops_(ops) {
+        std::mt19937_64 rng(42);
+        ids_.resize(book_size_ + ops_);
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            ids_[i] = distribution == IdDistribution::SEQUENTIAL ? i + 1 : (rng() | 1);
+        }
+
+        order_.resize(ops_);
+        std::iota(order_.begin(), order_.end(), 0);
+        if (distribution == IdDistribution::RANDOM) {
+            std::shuffle(order_.begin(), order_.end(), rng);
+        }
+    }
+
+    size_t capacity() const { return ids_.size(); }
+
+    //The i-th resting order of the book, spread round-robin over the instruments
+    NewOrder book_order(size_t i) const { return make_order(ids_[i], i); }
+
+    //The i-th order added on top of the book
+    NewOrder extra_order(size_t i) const { return make_order(ids_[book_size_ + i], i); }
+
+    //Which extra order the i-th delete targets
+    uint64_t extra_id(size_t i) const { return ids_[book_size_ + order_[i]]; }
+
+    //Which book order the i-th modify targets
+    uint64_t book_id(size_t i) const { return ids_[order_[i] % book_size_]; }
+
+    uint64_t instrument(size_t i) const { return i % instruments_ + 1; }
+
+    void fill(State& state) const {
+        for (size_t i = 0; i < book_size_; ++i) {
+            state.add_order_if_accepted(book_order(i));
+        }
+    }
+
+private:
+    size_t instruments_;
+    size_t book_size_;
+    size_t ops_;
+    std::vector<uint64_t> ids_;
+    std::vector<size_t> order_;
+
+    NewOrder make_order(uint64_t order_id, size_t i) const {
+        return {NewOrder::MESSAGE_TYPE, instrument(i), order_id, 1, 100, i % 2 == 0 ? 'B' : 'S'};
+    }
+};
+
+//Runs op(i) for every operation and fills in the timing and allocation figures
+template <typename Op>
+void measure(Result& result, size_t ops, Op&& op) {
+    uint64_t allocations_before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        op(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    result.ops = ops;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+    result.allocs_per_op = static_cast<double>(allocations - allocations_before) / ops;
+}
+
+void run_grid_point(size_t instruments, size_t depth, IdDistribution distribution, size_t ops,
+                    std::vector<Result>& results) {
+    Workload workload(instruments, depth, ops, distribution);
+    Result base{nullptr, instruments, depth, distribution, ops, 0, 0};
+    uint64_t accepted = 0;
+
+    //NewOrders added on top of a book resting at the given depth
+    {
+        State state(THRESHOLD, THRESHOLD, workload.capacity());
+        workload.fill(state);
+        std::vector<NewOrder> orders(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            orders[i] = workload.extra_order(i);
+        }
+        Result result = base;
+        result.operation = "add_order";
+        measure(result, ops, [&](size_t i) { accepted += state.add_order_if_accepted(orders[i]); });
+        results.push_back(result);
+    }
+
+    //Deletes of those added orders, leaving the book at the given depth again
+    {
+        State state(THRESHOLD, THRESHOLD, workload.capacity());
+        workload.fill(state);
+        for (size_t i = 0; i < ops; ++i) {
+            state.add_order_if_accepted(workload.extra_order(i));
+        }
+        std::vector<DeleteOrder> deletes(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            deletes[i] = {DeleteOrder::MESSAGE_TYPE, workload.extra_id(i)};
+        }
+        Result result = base;
+        result.operation = "delete_order";
+        measure(result, ops, [&](size_t i) { accepted += state.delete_order(deletes[i]); });
+        results.push_back(result);
+    }
+
+    //Quantity changes of resting orders, alternating between 1 and 2 lots
+    {
+        State state(THRESHOLD, THRESHOLD, workload.capacity());
+        workload.fill(state);
+        std::vector<ModifyOrderQty> modifies(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            modifies[i] = {ModifyOrderQty::MESSAGE_TYPE, workload.book_id(i), 1 + i % 2};
+        }
+        Result result = base;
+        result.operation = "modify_order";
+        measure(result, ops, [&](size_t i) { accepted += state.modify_order_if_accepted(modifies[i]); });
+        results.push_back(result);
+    }
+
+    //Fills alternating between buying and selling so positions stay bounded
+    {
+        State state(THRESHOLD, THRESHOLD, workload.capacity());
+        workload.fill(state);
+        std::vector<Trade> trades(ops);
+        for (size_t i = 0; i < ops; ++i) {
+            trades[i] = {Trade::MESSAGE_TYPE, workload.instrument(i), i + 1, i % 2 == 0 ? 1 : -1, 100};
+        }
+        Result result = base;
+        result.operation = "process_trade";
+        measure(result, ops, [&](size_t i) { state.process_trade(trades[i]); });
+        results.push_back(result);
+    }
+
+    sink = accepted;
+}
+
+bool parse_sizes(const char* text, std::vector<size_t>& values) {
+    values.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        char* parse_end = nullptr;
+        std::string item = list.substr(start, end - start);
+        unsigned long long value = std::strtoull(item.c_str(), &parse_end, 10);
+        if (item.empty() || *parse_end != '\0' || value == 0) {
+            return false;
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return true;
+}
+
+bool parse_distributions(const char* text, std::vector<IdDistribution>& values) {
+    values.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(start, end - start);
+        if (item == "sequential") {
+            values.push_back(IdDistribution::SEQUENTIAL);
+        } else if (item == "random") {
+            values.push_back(IdDistribution::RANDOM);
+        } else {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool parse_args(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* option = argv[i];
+        const char* value = argv[i + 1];
+        std::vector<size_t> ops;
+        bool ok;
+        if (strcmp(option, "--instruments") == 0) {
+            ok = parse_sizes(value, config.instruments);
+        } else if (strcmp(option, "--depths") == 0) {
+            ok = parse_sizes(value, config.depths);
+        } else if (strcmp(option, "--ids") == 0) {
+            ok = parse_distributions(value, config.distributions);
+        } else if (strcmp(option, "--ops") == 0) {
+            ok = parse_sizes(value, ops) && ops.size() == 1;
+            if (ok) {
+                config.ops = ops.front();
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid value for " << option << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_json(const BenchConfig& config, const std::vector<Result>& results) {
+    std::cout << "{\n  \"benchmark\": \"RiskBench\",\n  \"ops\": " << config.ops << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::cout << "    {\"operation\": \"" << result.operation << "\""
+                  << ", \"instruments\": " << result.instruments
+                  << ", \"depth\": " << result.depth
+                  << ", \"ids\": \"" << (result.distribution == IdDistribution::SEQUENTIAL ? "sequential" : "random") << "\""
+                  << ", \"ops\": " << result.ops
+                  << ", \"ns_per_op\": " << result.ns_per_op
+                  << ", \"ops_per_sec\": " << 1e9 / result.ns_per_op
+                  << ", \"allocs_per_op\": " << result.allocs_per_op << "}"
+                  << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    std::cout << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parse_args(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--instruments 1,64,1024] [--depths 1,64,512] [--ids sequential,random] [--ops 100000]\n";
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (size_t instruments : config.instruments) {
+        for (size_t depth : config.depths) {
+            for (IdDistribution distribution : config.distributions) {
+                run_grid_point(instruments, depth, distribution, config.ops, results);
+            }
+        }
+    }
+    write_json(config, results);
+    return 0;
+}
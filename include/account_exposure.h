@@ -0,0 +1,73 @@
+//account_exposure.h
+//
+//This header file defines the AccountExposure class, the running totals behind
+//the account-level risk limits.
+//
+//An account is a session, and its instruments are spread over every shard, so
+//each shard's State adds the change its own instrument made rather than
+//recomputing a total. An increase is reserved with a compare-and-swap that
+//fails when the total would cross the limit, so two shards can never both take
+//the last of the headroom; a decrease is applied unconditionally. Both totals
+//share one cache line, as every order touches both.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef ACCOUNT_EXPOSURE_H_
+#define ACCOUNT_EXPOSURE_H_
+
+#include <atomic>
+#include <cstdint>
+
+class AccountExposure {
+public:
+    AccountExposure() = default;
+
+    AccountExposure(const AccountExposure&) = delete;
+    AccountExposure& operator=(const AccountExposure&) = delete;
+
+    //Adds both deltas if neither total would cross its limit (0 for no limit), otherwise
+    //changes nothing and returns false. Decreases always succeed.
+    bool try_add(int64_t position_delta, int64_t notional_delta, int64_t max_position, int64_t max_notional) {
+        if (!try_add(position_, position_delta, max_position)) {
+            return false;
+        }
+        if (!try_add(notional_, notional_delta, max_notional)) {
+            position_.fetch_sub(position_delta, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    //Applies deltas that cannot be refused, such as a trade or a cancel
+    void add(int64_t position_delta, int64_t notional_delta) {
+        position_.fetch_add(position_delta, std::memory_order_relaxed);
+        notional_.fetch_add(notional_delta, std::memory_order_relaxed);
+    }
+
+    //Sum of every instrument's worst position, buy or sell
+    int64_t position() const { return position_.load(std::memory_order_relaxed); }
+
+    //Sum of order_qty * order_price over every resting order
+    int64_t notional() const { return notional_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<int64_t> position_{0};
+    std::atomic<int64_t> notional_{0};
+
+    static bool try_add(std::atomic<int64_t>& total, int64_t delta, int64_t limit) {
+        if (delta <= 0 || limit == 0) {
+            total.fetch_add(delta, std::memory_order_relaxed);
+            return true;
+        }
+        int64_t current = total.load(std::memory_order_relaxed);
+        do {
+            if (current > limit - delta) {
+                return false;
+            }
+        } while (!total.compare_exchange_weak(current, current + delta, std::memory_order_relaxed));
+        return true;
+    }
+};
+
+#endif //ACCOUNT_EXPOSURE_H_
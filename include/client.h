@@ -25,6 +25,19 @@ public:
 
     bool receive_response(char* buffer, size_t size);
 
+    //Switches the connection to non-blocking mode for the *_some calls below
+    bool set_nonblocking();
+
+    //Sends what the socket accepts without blocking. Returns the bytes sent,
+    //0 if the socket buffer is full, or -1 on error.
+    ssize_t send_some(const char* data, size_t size);
+
+    //Receives what is available without blocking. Returns the bytes received,
+    //0 if nothing is waiting, or -1 on error or when the server closed the connection.
+    ssize_t receive_some(char* buffer, size_t size);
+
+    int socket_fd() const { return server_socket_; }
+
 private:
     int server_socket_;
     std::string server_ip_;
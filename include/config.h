@@ -0,0 +1,131 @@
+//config.h
+//
+//This header file defines the ServerConfig structure, which collects the
+//runtime settings of the RiskServer, and the command line parser used by
+//main.cpp to fill it in.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "logger.h"
+#include "shm_ring.h"
+
+//Position limits of a session that clients may log on to
+struct SessionLimits {
+    uint64_t session_id;
+    int64_t max_buy_position;
+    int64_t max_sell_position;
+};
+
+//What happens to a session's resting orders when its last order connection closes
+enum class DisconnectPolicy {
+    RETAIN, //Keep them, so the client can reconnect and carry on
+    CANCEL, //Cancel them all; positions from trades are kept
+};
+
+//Which event loops accept new connections
+enum class AcceptMode {
+    SHARED,    //The first loop owns the listeners and hands connections out round-robin
+    REUSEPORT, //Every socket loop has listeners of its own in a SO_REUSEPORT group
+};
+
+//How the event loops wait for and perform socket I/O
+enum class IoBackend {
+    EPOLL, //Readiness notification, one recv/send syscall per operation
+    URING, //io_uring completions, batched into one io_uring_enter per loop round
+};
+
+struct ServerConfig {
+    int64_t max_buy_position = 0;
+    int64_t max_sell_position = 0;
+
+    //Sessions clients may log on to, from --session-limits. Session 0 is always
+    //there and takes the limits above; a Logon to any other session is rejected.
+    std::vector<SessionLimits> sessions;
+
+    //Per-order limits applied to every session; 0 disables each check
+    uint64_t max_order_qty = 0;
+    uint64_t max_notional = 0;     //order_qty * order_price
+    uint64_t price_collar_bps = 0; //Distance from the instrument's last trade price
+
+    //Account limits over all of a session's instruments; 0 disables each
+    int64_t max_account_position = 0; //Sum of every instrument's worst position
+    int64_t max_account_notional = 0; //Sum of the resting orders' notional
+
+    //Per-message logging; OFF removes it from the hot path entirely
+    LogLevel log_level = LogLevel::INFO;
+
+    int order_port = 55555;
+    int trade_port = 55556;
+
+    //Number of event-loop threads driving the client connections
+    int io_threads = 1;
+
+    //Falls back to EPOLL when the kernel or the build lacks io_uring
+    IoBackend io_backend = IoBackend::EPOLL;
+
+    AcceptMode accept_mode = AcceptMode::SHARED;
+
+    //Number of State shards, each run by its own worker thread
+    int shards = 1;
+
+    //Core for each shard worker; shards without an entry are not pinned
+    std::vector<int> shard_cores;
+
+    //Core for each event loop, socket loops first and then one per --shm gateway;
+    //loops without an entry are not pinned
+    std::vector<int> io_cores;
+
+    //SCHED_FIFO priority (1-99) for the event loops and shard workers; 0 leaves them SCHED_OTHER
+    int sched_fifo_priority = 0;
+
+    //Microseconds of SO_BUSY_POLL on the sockets; non-zero also keeps the event loops
+    //and shard workers spinning instead of ever sleeping. 0 lets them block when idle.
+    int busy_poll_us = 0;
+
+    //Resting orders each shard preallocates storage for, per session
+    int max_orders = 65536;
+
+    //Directory for the per-shard write-ahead journals; empty disables journaling
+    std::string journal_dir;
+    JournalSync journal_sync = JournalSync::NONE;
+    int journal_sync_interval_ms = 0;
+
+    //Seconds between State snapshots in the journal directory; 0 takes them only on SIGUSR2
+    int snapshot_interval_s = 0;
+
+    DisconnectPolicy on_disconnect = DisconnectPolicy::RETAIN;
+
+    //Responses a connection batches before they are sent without waiting for the
+    //end of the event-loop round; 1 sends every response at once
+    int response_batch = 64;
+
+    //UDP trade feed, multicast or unicast; an empty address disables it
+    std::string trade_feed_address;
+    int trade_feed_port = 0;
+    std::string trade_feed_interface; //Local address to join a multicast feed on
+    int trade_feed_window = 1024;     //Trades that can be held back waiting for a missing one
+    int trade_feed_gap_ms = 10;       //How long a missing trade is waited for
+
+    //Shared-memory segments in /dev/shm, one per co-located gateway, each served by its own thread
+    std::vector<std::string> shm_gateways;
+    ShmWait shm_wait = ShmWait::FUTEX;
+
+    //Shared-memory segment in /dev/shm the live instrument counters are published to; empty disables it
+    std::string position_board;
+    int position_board_capacity = 65536; //Instruments, over every session, the board has room for
+};
+
+//Parses "<max_buy_position> <max_sell_position> [--option value ...]".
+//Prints the usage and returns false on malformed input.
+bool parse_server_config(int argc, char* argv[], ServerConfig& config);
+
+#endif //CONFIG_H_
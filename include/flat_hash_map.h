@@ -0,0 +1,206 @@
+//flat_hash_map.h
+//
+//This header file defines the FlatHashMap class template, an open-addressing
+//hash table specialised for uint64_t keys such as instrument IDs.
+//
+//Entries are stored inline in one contiguous array, so a lookup touches one
+//or two cache lines instead of chasing a node pointer per entry like
+//std::unordered_map. Collisions are resolved by linear probing: the probe
+//sequence walks consecutive slots, which the hardware prefetcher follows. A
+//separate byte array marks which slots are occupied, so keys need no reserved
+//sentinel value.
+//
+//Only the subset of the std::unordered_map interface used by the server is
+//provided. Like std::unordered_map, inserting may rehash and invalidate
+//references and iterators; sizing the table up front avoids that. Erasing
+//shifts later entries back instead of leaving tombstones.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef FLAT_HASH_MAP_H_
+#define FLAT_HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template <typename V>
+class FlatHashMap {
+public:
+    using value_type = std::pair<uint64_t, V>;
+
+    template <typename Map, typename Value>
+    class Iterator {
+    public:
+        Iterator(Map* map, size_t index) : map_(map), index_(index) { skip_empty(); }
+
+        Value& operator*() const { return map_->slots_[index_]; }
+        Value* operator->() const { return &map_->slots_[index_]; }
+
+        Iterator& operator++() {
+            ++index_;
+            skip_empty();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        Map* map_;
+        size_t index_;
+
+        void skip_empty() {
+            while (index_ < map_->slots_.size() && !map_->occupied_[index_]) {
+                ++index_;
+            }
+        }
+    };
+
+    using iterator = Iterator<FlatHashMap, value_type>;
+    using const_iterator = Iterator<const FlatHashMap, const value_type>;
+
+    explicit FlatHashMap(size_t capacity = 16) { allocate(capacity); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    iterator find(uint64_t key) {
+        size_t index;
+        return locate(key, index) ? iterator(this, index) : end();
+    }
+
+    const_iterator find(uint64_t key) const {
+        size_t index;
+        return locate(key, index) ? const_iterator(this, index) : end();
+    }
+
+    size_t count(uint64_t key) const {
+        size_t index;
+        return locate(key, index) ? 1 : 0;
+    }
+
+    V& at(uint64_t key) {
+        size_t index;
+        if (!locate(key, index)) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return slots_[index].second;
+    }
+
+    const V& at(uint64_t key) const {
+        size_t index;
+        if (!locate(key, index)) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return slots_[index].second;
+    }
+
+    V& operator[](uint64_t key) {
+        size_t index;
+        if (locate(key, index)) {
+            return slots_[index].second;
+        }
+
+        //Keep the load factor at or below 3/4 so probe sequences stay short
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            rehash(slots_.size() * 2);
+            locate(key, index);
+        }
+        occupied_[index] = 1;
+        slots_[index] = value_type(key, V());
+        ++size_;
+        return slots_[index].second;
+    }
+
+    size_t erase(uint64_t key) {
+        size_t hole;
+        if (!locate(key, hole)) {
+            return 0;
+        }
+
+        //Backward-shift deletion: pull later entries of the probe run into the hole,
+        //so lookups never need tombstones
+        size_t next = (hole + 1) & mask_;
+        while (occupied_[next]) {
+            size_t desired = home(slots_[next].first);
+            if (((next - desired) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        occupied_[hole] = 0;
+        slots_[hole] = value_type();
+        --size_;
+        return 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (occupied_[i]) {
+                slots_[i] = value_type();
+                occupied_[i] = 0;
+            }
+        }
+        size_ = 0;
+    }
+
+private:
+    std::vector<value_type> slots_;
+    std::vector<uint8_t> occupied_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+
+    void allocate(size_t capacity) {
+        size_t size = 16;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.assign(size, value_type());
+        occupied_.assign(size, 0);
+        mask_ = size - 1;
+    }
+
+    size_t home(uint64_t key) const {
+        //Fibonacci hashing: the high bits of the product mix every bit of the key
+        return (key * 0x9E3779B97F4A7C15ULL >> 32) & mask_;
+    }
+
+    //Returns true and the key's slot if present, otherwise false and the free slot it would take
+    bool locate(uint64_t key, size_t& index) const {
+        index = home(key);
+        while (occupied_[index]) {
+            if (slots_[index].first == key) {
+                return true;
+            }
+            index = (index + 1) & mask_;
+        }
+        return false;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<value_type> old_slots = std::move(slots_);
+        std::vector<uint8_t> old_occupied = std::move(occupied_);
+        allocate(capacity);
+
+        for (size_t i = 0; i < old_slots.size(); ++i) {
+            if (old_occupied[i]) {
+                size_t index;
+                locate(old_slots[i].first, index);
+                occupied_[index] = 1;
+                slots_[index] = std::move(old_slots[i]);
+            }
+        }
+    }
+};
+
+#endif //FLAT_HASH_MAP_H_
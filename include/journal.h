@@ -0,0 +1,151 @@
+//journal.h
+//
+//This header file declares the write-ahead journal that makes the risk state
+//survive a restart.
+//
+//Every shard appends the messages that changed its sessions' State (accepted
+//NewOrders, deletes and modifies, every Trade, session creation and mass
+//cancels) to its own append-only file, each tagged with its session. Records are
+//collected in memory while the shard works through a batch of requests and
+//written with a single write() before any response of that batch is released
+//(group commit), so a client never sees an acceptance that is not in the
+//journal. How often the file is also flushed to disk is set by JournalSync.
+//
+//On startup JournalReader maps the file into memory and hands the records back
+//for replay. A record that was only partly written when the process died fails
+//its length or checksum test; replay stops there and the journal is truncated
+//to the last intact record before new records are appended.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//When journal writes are flushed to disk with fdatasync
+enum class JournalSync {
+    NONE,     //Never; a process crash loses nothing, a power loss may
+    BATCH,    //Before the responses of every batch are released
+    PERIODIC, //At most once per interval, and before the shard goes idle
+};
+
+//Parses "none", "batch" or a sync interval in milliseconds
+bool parse_journal_sync(const char* text, JournalSync& sync, int& interval_ms);
+
+struct JournalFileHeader {
+    static constexpr uint32_t MAGIC = 0x4A4B5352; //"RSKJ"
+    static constexpr uint16_t VERSION = 3; //2: records carry a session ID, 3: Logons carry nothing else
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t shard;       //Which shard wrote the file
+    uint16_t shard_count; //Instruments are partitioned by this count
+    uint16_t reserved[3];
+} __attribute__((__packed__));
+
+static_assert(sizeof(JournalFileHeader) == 16, "JournalFileHeader size is not 16 bytes");
+
+//Precedes every record; the payload is the wire message that was applied
+struct JournalRecordHeader {
+    uint16_t message_type; //ShardRequest::CANCEL_ALL or a wire MESSAGE_TYPE
+    uint16_t payload_size;
+    uint32_t checksum;     //Over the session, message type, size and payload
+    uint64_t session_id;
+} __attribute__((__packed__));
+
+static_assert(sizeof(JournalRecordHeader) == 16, "JournalRecordHeader size is not 16 bytes");
+
+//Reads a journal file through a read-only memory mapping
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    //Maps the file. A missing or empty file is a valid, empty journal.
+    //Returns false if the file cannot be read or has a foreign header.
+    bool open(const std::string& path);
+
+    //Header of the mapped file, or nullptr for an empty journal
+    const JournalFileHeader* header() const { return header_; }
+
+    //Advances to the next intact record. Returns false at the end of the
+    //journal or at the first torn record.
+    bool next(const JournalRecordHeader*& record, const char*& payload);
+
+    //Where the next record would start: the end of the last intact record
+    size_t offset() const { return offset_; }
+
+    //Continues reading at a record boundary, such as a snapshot's journal offset.
+    //Returns false if the offset lies outside the journal.
+    bool skip_to(size_t offset);
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+    const JournalFileHeader* header_ = nullptr;
+};
+
+//Appends records to a journal file. Owned and used by a single shard thread.
+class Journal {
+public:
+    Journal() = default;
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    //Opens the file for appending after `valid_size` bytes (see JournalReader::offset),
+    //dropping anything past them. Writes a fresh header into an empty file.
+    bool open(const std::string& path, size_t valid_size, uint16_t shard, uint16_t shard_count,
+              JournalSync sync, int sync_interval_ms);
+
+    //Buffers a record; nothing reaches the file until commit()
+    void append(uint64_t session_id, uint16_t message_type, const void* payload, uint16_t payload_size);
+
+    template <typename Message>
+    void append(uint64_t session_id, const Message& message) {
+        append(session_id, Message::MESSAGE_TYPE, &message, sizeof(message));
+    }
+
+    //Writes the buffered records and syncs them as the policy requires. If the
+    //write or sync fails the buffered records are dropped, a partly written batch
+    //is cut off, and the journal stays failed: every later commit() returns false.
+    bool commit();
+
+    //Syncs anything written but not yet on disk. Called before the shard sleeps.
+    bool sync();
+
+    //Bytes in the file, including the header and buffered records
+    uint64_t size() const { return file_size_ + buffer_.size(); }
+
+    //A write or sync has failed; the file no longer follows the records appended
+    bool failed() const { return failed_; }
+
+private:
+    int fd_ = -1;
+    std::string path_;
+    JournalSync sync_ = JournalSync::NONE;
+    int64_t sync_interval_ns_ = 0;
+    int64_t last_sync_ns_ = 0;
+    bool dirty_ = false; //Written since the last sync
+    bool failed_ = false;
+    uint64_t file_size_ = 0;
+    std::vector<char> buffer_;
+
+    bool sync_now();
+    void fail();
+};
+
+//Checksum of a journal record
+uint32_t journal_checksum(uint64_t session_id, uint16_t message_type, uint16_t payload_size, const char* payload);
+
+#endif //JOURNAL_H_
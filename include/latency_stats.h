@@ -0,0 +1,124 @@
+//latency_stats.h
+//
+//This header file declares the latency instrumentation of the message
+//pipeline: a cheap TSC-based clock, an HDR-style LatencyHistogram and the
+//LatencyStats registry that reports them.
+//
+//Every thread records into its own set of histograms (one per message type
+//and pipeline stage), created on its first sample. A histogram is only ever
+//written by its owning thread, with plain relaxed stores, so recording costs a
+//few instructions and no shared cache line. Readers merge all threads' copies
+//when a report is requested.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef LATENCY_STATS_H_
+#define LATENCY_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+//Reads the CPU timestamp counter where available, otherwise a monotonic clock
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return steady_ns();
+#endif
+    }
+
+    //Measures the tick rate against the monotonic clock. Call once at startup.
+    static void calibrate();
+
+    static uint64_t to_ns(uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick_);
+    }
+
+private:
+    static uint64_t steady_ns();
+    static double ns_per_tick_;
+};
+
+//Log-linear histogram: every power of two is split into SUB_BUCKETS linear
+//buckets, so each recorded value is kept to within about 3%
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAGNITUDES = 64 - SUB_BUCKET_BITS + 1; //The exact range plus one per shift
+    static constexpr int BUCKETS = MAGNITUDES * SUB_BUCKETS;
+
+    //Owner thread only
+    void record(uint64_t value) {
+        auto& bucket = counts_[bucket_for(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    //Adds this histogram's counts to a merged copy; safe from any thread
+    void merge_into(std::vector<uint64_t>& counts, uint64_t& max) const;
+
+    static int bucket_for(uint64_t value);
+
+    //Largest value that falls into a bucket
+    static uint64_t bucket_upper_bound(int bucket);
+
+    //Value at the given percentile (0-100) of merged counts
+    static uint64_t percentile(const std::vector<uint64_t>& counts, double percent);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> max_{0};
+};
+
+class LatencyStats {
+public:
+    //Measured message types, indexed by MESSAGE_TYPE - 1
+    static constexpr int MESSAGE_TYPES = 4;
+
+    enum Stage {
+        PARSE,   //recv() to the request being queued for a shard
+        QUEUE,   //Waiting in the shard's queue
+        CHECK,   //The State operation itself
+        RESPOND, //Response queued to response sent
+        TOTAL,   //recv() to response sent (to the state update for trades)
+        STAGES,
+    };
+
+    static LatencyStats& instance();
+
+    //Records a stage latency, in TSC ticks, for a wire message type
+    void record(uint16_t message_type, Stage stage, uint64_t ticks) {
+        if (message_type == 0 || message_type > MESSAGE_TYPES) {
+            return;
+        }
+        thread_histograms().histograms[message_type - 1][stage].record(TscClock::to_ns(ticks));
+    }
+
+    //Writes p50/p99/p99.9/max in nanoseconds for every type and stage with samples
+    void report(std::ostream& out);
+
+private:
+    struct ThreadHistograms {
+        LatencyHistogram histograms[MESSAGE_TYPES][STAGES];
+    };
+
+    LatencyStats() = default;
+
+    std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<ThreadHistograms>> threads_;
+
+    ThreadHistograms& thread_histograms();
+};
+
+#endif //LATENCY_STATS_H_
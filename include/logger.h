@@ -0,0 +1,91 @@
+//logger.h
+//
+//This header file declares the Logger class, an asynchronous binary logger
+//that keeps formatting and terminal I/O off the message path.
+//
+//The hot path only copies a compact LogEvent into a lock-free ring owned by
+//the calling thread; one background thread drains every ring and formats the
+//events to stdout. When a ring is full the event is dropped and counted
+//rather than stalling the caller. At LogLevel::OFF nothing is recorded at all.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.h"
+#include "state.h"
+
+enum class LogLevel : uint8_t {
+    OFF = 0,  //Nothing is logged
+    WARN = 1, //Only rejected messages
+    INFO = 2, //Every message, with the instrument's state after it
+};
+
+//Parses "off", "warn" or "info"
+bool parse_log_level(const char* text, LogLevel& level);
+
+//One processed message, as recorded on the hot path
+struct LogEvent {
+    uint64_t timestamp;
+    uint64_t instrument_id;
+    uint64_t order_id;      //Trade ID for trades
+    int64_t quantity;       //New quantity for modifies
+    uint64_t price;
+    State::Position position; //The instrument after the message, if has_position
+    uint16_t message_type;
+    char side;
+    bool accepted;
+    bool has_position;
+};
+
+class Logger {
+public:
+    static Logger& instance();
+
+    //Starts the formatting thread. Events are only recorded while started.
+    void start(LogLevel level);
+
+    //Formats whatever is still queued and stops the formatting thread
+    void stop();
+
+    bool enabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) <= level_.load(std::memory_order_relaxed);
+    }
+
+    //Queues an event without blocking. Stamps the current time.
+    void log(LogEvent event);
+
+    //Events lost because a ring was full
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t RING_CAPACITY = 16384;
+
+    Logger() = default;
+
+    std::atomic<uint8_t> level_{static_cast<uint8_t>(LogLevel::OFF)};
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+
+    //One ring per producing thread, created on that thread's first event
+    std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<SpscQueue<LogEvent>>> rings_;
+
+    SpscQueue<LogEvent>& ring_for_this_thread();
+    void run();
+    size_t drain(std::string& output);
+    static void format(const LogEvent& event, std::string& output);
+};
+
+#endif //LOGGER_H_
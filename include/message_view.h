@@ -0,0 +1,101 @@
+//message_view.h
+//
+//This header file defines typed, read-only views over messages that are still
+//sitting in a receive buffer, and the compile-time dispatch table that maps a
+//MESSAGE_TYPE to its handler.
+//
+//A FrameView reads the Header fields and the message type in place, so parsing
+//a frame needs no stack copy of the Header. A MessageView<Message> is only made
+//once the payload is known to hold a whole Message; its single copy goes
+//straight into the message's final destination. The wire structs are packed,
+//so every access goes through memcpy, which compiles to plain loads.
+//
+//A DispatchTable has one entry per MESSAGE_TYPE, built by make_dispatch_table()
+//from a list of message structs: the entry's minimum size is sizeof the struct
+//and its handler is the instantiation for that struct. Types missing from the
+//list have a null handler, so one table per port also decides which messages
+//the port accepts. Adding a message type is one more struct in the list.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef MESSAGE_VIEW_H_
+#define MESSAGE_VIEW_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "order.h"
+
+class FrameView {
+public:
+    //`data` must hold at least a Header and the two-byte message type
+    static constexpr size_t MIN_SIZE = sizeof(Header) + sizeof(uint16_t);
+
+    explicit FrameView(const char* data) : data_(data) {}
+
+    uint16_t payload_size() const { return read<uint16_t>(offsetof(Header, payload_size)); }
+    uint32_t sequence_number() const { return read<uint32_t>(offsetof(Header, sequence_number)); }
+
+    //Every message struct starts with its message_type
+    uint16_t message_type() const { return read<uint16_t>(sizeof(Header)); }
+
+    const char* payload() const { return data_ + sizeof(Header); }
+
+private:
+    const char* data_;
+
+    template <typename Field>
+    Field read(size_t offset) const {
+        Field value;
+        memcpy(&value, data_ + offset, sizeof(Field));
+        return value;
+    }
+};
+
+template <typename Message>
+class MessageView {
+public:
+    static_assert(std::is_trivially_copyable_v<Message>, "Wire messages must be trivially copyable");
+    static_assert(alignof(Message) == 1, "Wire messages must be packed");
+
+    //`data` must hold at least sizeof(Message) bytes
+    explicit MessageView(const char* data) : data_(data) {}
+
+    //Reads one field in place, e.g. get<uint64_t>(offsetof(NewOrder, order_id))
+    template <typename Field>
+    Field get(size_t offset) const {
+        Field value;
+        memcpy(&value, data_ + offset, sizeof(Field));
+        return value;
+    }
+
+    //The one copy of the parse path, into wherever the message is going
+    void copy_to(Message& destination) const { memcpy(&destination, data_, sizeof(Message)); }
+
+private:
+    const char* data_;
+};
+
+template <typename Handler>
+struct DispatchEntry {
+    size_t size = 0;          //Smallest payload accepted: sizeof the message struct
+    Handler handler = nullptr; //Null when the type is not accepted
+};
+
+template <typename Handler>
+using DispatchTable = std::array<DispatchEntry<Handler>, MAX_MESSAGE_TYPE + 1>;
+
+//Builds the table for `Messages`; bind.operator()<Message>() returns the handler for each
+template <typename Handler, typename... Messages, typename Bind>
+constexpr DispatchTable<Handler> make_dispatch_table(Bind bind) {
+    static_assert(((Messages::MESSAGE_TYPE <= MAX_MESSAGE_TYPE) && ...), "Raise MAX_MESSAGE_TYPE in order.h");
+    DispatchTable<Handler> table{};
+    ((table[Messages::MESSAGE_TYPE] = {sizeof(Messages), bind.template operator()<Messages>()}), ...);
+    return table;
+}
+
+#endif //MESSAGE_VIEW_H_
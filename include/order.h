@@ -11,6 +11,7 @@
 //- `Trade`: Represents a trade message.
 //- `OrderResponse`: Represents a response message from the server indicating 
 //whether an order was accepted or rejected.
+//- `Logon`: Binds a connection to a session, which owns its own risk state.
 //
 //Each structure uses `__attribute__((__packed__))` to ensure no padding is added 
 //between members, and `static_assert` is used to verify the size of each structure.
@@ -85,4 +86,20 @@ struct OrderResponse {
 
 static_assert(sizeof(OrderResponse) == 12, "The order_response size is not correct");
 
+//Optional first message of a connection. Connections that never log on use
+//session 0 with the server's thresholds. Zero thresholds keep the session's
+//existing limits, or the server's for a new session. Answered with an
+//OrderResponse whose order_id is the session ID.
+//The session's limits come from the server's configuration, never from the client
+struct Logon {
+    static constexpr uint16_t MESSAGE_TYPE = 6;
+    uint16_t message_type;
+    uint64_t session_id;
+} __attribute__((__packed__));
+
+static_assert(sizeof(Logon) == 10, "The logon size is not correct");
+
+//Highest MESSAGE_TYPE above; sizes the per-type dispatch tables
+constexpr uint16_t MAX_MESSAGE_TYPE = Logon::MESSAGE_TYPE;
+
 #endif  
\ No newline at end of file
@@ -0,0 +1,67 @@
+//order_pool.h
+//
+//This header file declares the OrderPool class, a fixed-size slab that holds
+//every resting order of a State.
+//
+//All nodes are allocated up front, so adding and cancelling orders never
+//calls malloc. Free nodes are chained through an intrusive free list, and
+//live nodes are chained into a doubly linked list per instrument, so an order
+//is unlinked in O(1) without shifting any other order. Nodes are addressed by
+//32-bit index rather than pointer to keep them small.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef ORDER_POOL_H_
+#define ORDER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class OrderPool {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr size_t MAX_CAPACITY = NONE; //Every index must be below NONE
+
+    struct Node {
+        uint64_t order_id;
+        uint64_t instrument_id;
+        uint64_t order_qty;
+        uint64_t order_price;
+        uint32_t prev; //Previous order of the same instrument, or NONE
+        uint32_t next; //Next order of the same instrument (or next free node), or NONE
+        char side;     //'B' for buy, 'S' for sell
+    };
+
+    //The capacity is capped at MAX_CAPACITY
+    explicit OrderPool(size_t capacity);
+
+    //Takes a node off the free list. Returns NONE when the pool is exhausted.
+    uint32_t allocate();
+
+    //Puts a node back on the free list
+    void release(uint32_t index);
+
+    //Links a node in front of the list starting at head
+    void link_front(uint32_t& head, uint32_t index);
+
+    //Unlinks a node from the list starting at head
+    void unlink(uint32_t& head, uint32_t index);
+
+    //Returns every node to the free list
+    void reset();
+
+    Node& operator[](uint32_t index) { return nodes_[index]; }
+    const Node& operator[](uint32_t index) const { return nodes_[index]; }
+
+    size_t capacity() const { return nodes_.size(); }
+    size_t in_use() const { return in_use_; }
+
+private:
+    std::vector<Node> nodes_;
+    uint32_t free_head_;
+    size_t in_use_ = 0;
+};
+
+#endif //ORDER_POOL_H_
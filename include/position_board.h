@@ -0,0 +1,134 @@
+//position_board.h
+//
+//This header file declares the position board, a shared-memory segment in
+///dev/shm through which the server publishes every instrument's live counters
+//(net position, buy_qty and sell_qty, per session) to other processes.
+//
+//Each published instrument has a 64-byte slot written only by the shard that
+//owns it, guarded by a seqlock: the writer makes the slot's sequence odd,
+//stores the counters and makes it even again. A reader copies the counters
+//between two loads of the sequence and retries if they differ or are odd, so
+//readers never block the shard, take no lock and make no syscall, and a shard
+//never waits for them. Slots are claimed once, on an instrument's first
+//publish, by bumping a shared counter.
+//
+//PositionBoard is the server's side; PositionBoardReader maps the segment
+//read-only for dashboards, and RiskPositions wraps it as a command line tool.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef POSITION_BOARD_H_
+#define POSITION_BOARD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//One instrument of one session
+struct alignas(64) PositionSlot {
+    std::atomic<uint32_t> sequence; //Odd while being written, 0 until first published
+    uint32_t shard;
+    std::atomic<uint64_t> session_id;
+    std::atomic<uint64_t> instrument_id;
+    std::atomic<int64_t> net_position;
+    std::atomic<int64_t> buy_qty;
+    std::atomic<int64_t> sell_qty;
+    std::atomic<uint64_t> updates; //Times the slot was published
+};
+
+static_assert(sizeof(PositionSlot) == 64, "PositionSlot size is not 64 bytes");
+
+//Starts the segment, followed by `capacity` slots
+struct alignas(64) PositionBoardHeader {
+    static constexpr uint32_t MAGIC = 0x50534B52; //"RKSP"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    std::atomic<uint64_t> slot_count; //Slots claimed so far; never shrinks
+    std::atomic<uint64_t> dropped;    //Instruments not published because the board was full
+};
+
+//A consistent copy of one slot
+struct PositionSample {
+    uint64_t session_id;
+    uint64_t instrument_id;
+    int64_t net_position;
+    int64_t buy_qty;
+    int64_t sell_qty;
+    uint64_t updates;
+    uint32_t shard;
+};
+
+class PositionBoard {
+public:
+    PositionBoard() = default;
+    ~PositionBoard();
+
+    PositionBoard(const PositionBoard&) = delete;
+    PositionBoard& operator=(const PositionBoard&) = delete;
+
+    //Creates /dev/shm/<name> with room for `capacity` instruments, replacing a
+    //stale one, and removes it again on destruction
+    bool create(const std::string& name, size_t capacity);
+
+    //Claims a slot for an instrument. Returns null once the board is full.
+    PositionSlot* claim(uint32_t shard, uint64_t session_id, uint64_t instrument_id);
+
+    //Stores new counters. Only the shard that claimed the slot may call it.
+    static void publish(PositionSlot& slot, int64_t net_position, int64_t buy_qty, int64_t sell_qty) {
+        uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.net_position.store(net_position, std::memory_order_relaxed);
+        slot.buy_qty.store(buy_qty, std::memory_order_relaxed);
+        slot.sell_qty.store(sell_qty, std::memory_order_relaxed);
+        slot.updates.store(slot.updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    std::string name_;
+    PositionBoardHeader* header_ = nullptr;
+    size_t size_ = 0;
+};
+
+class PositionBoardReader {
+public:
+    PositionBoardReader() = default;
+    ~PositionBoardReader();
+
+    PositionBoardReader(const PositionBoardReader&) = delete;
+    PositionBoardReader& operator=(const PositionBoardReader&) = delete;
+
+    //Maps an existing board read-only
+    bool open(const std::string& name);
+
+    //Slots claimed so far; read() accepts indexes below it
+    size_t slot_count() const;
+
+    //Instruments the server could not publish because the board was full
+    uint64_t dropped() const { return header_->dropped.load(std::memory_order_relaxed); }
+
+    //Copies slot `index` consistently. Returns false if it has not been published yet,
+    //or stays mid-write because the server died while writing it.
+    bool read(size_t index, PositionSample& sample) const;
+
+    //Copies every published slot into `samples`, reusing its storage
+    void sample(std::vector<PositionSample>& samples) const;
+
+    //Reads that were retried because a shard was writing the slot at the time
+    uint64_t retries() const { return retries_; }
+
+private:
+    const PositionBoardHeader* header_ = nullptr;
+    const PositionSlot* slots_ = nullptr;
+    size_t size_ = 0;
+    mutable uint64_t retries_ = 0;
+};
+
+#endif //POSITION_BOARD_H_
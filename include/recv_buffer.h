@@ -0,0 +1,58 @@
+//recv_buffer.h
+//
+//This header file declares the RecvBuffer class, the per-connection receive
+//buffer that turns a TCP byte stream back into messages.
+//
+//TCP is free to coalesce several messages into one segment or to split one
+//message across reads, so the server never assumes that a recv() returns a
+//whole message. Bytes are appended to the buffer as they arrive and complete
+//frames (a Header followed by Header.payload_size bytes) are handed out one
+//by one. A trailing partial frame is moved to the front of the buffer before
+//the next read, so every frame handed out is contiguous.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef RECV_BUFFER_H_
+#define RECV_BUFFER_H_
+
+#include "order.h"
+#include <cstddef>
+#include <vector>
+
+class RecvBuffer {
+public:
+    //Large enough for the biggest frame a uint16_t payload_size can describe
+    static constexpr size_t DEFAULT_CAPACITY = 128 * 1024;
+
+    enum class FrameStatus {
+        COMPLETE,   //A whole frame was returned
+        INCOMPLETE, //More bytes are needed
+        MALFORMED,  //The frame can never fit, the stream is unusable
+    };
+
+    RecvBuffer() : RecvBuffer(DEFAULT_CAPACITY) {}
+    explicit RecvBuffer(size_t capacity);
+
+    //Free space to recv() into. Invalidates frames returned earlier.
+    char* write_ptr();
+    size_t writable() const;
+
+    //Marks bytes written through write_ptr() as received
+    void commit(size_t size);
+
+    //Returns the next complete frame, header included. The frame stays
+    //valid until the next call to write_ptr().
+    FrameStatus next_frame(const char*& frame, size_t& size);
+
+    //Number of received bytes not yet returned as frames
+    size_t buffered() const { return tail_ - head_; }
+
+private:
+    size_t capacity_;
+    std::vector<char> data_; //Allocated on first use
+    size_t head_ = 0;
+    size_t tail_ = 0;
+};
+
+#endif //RECV_BUFFER_H_
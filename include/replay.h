@@ -0,0 +1,99 @@
+//replay.h
+//
+//This header file declares the replay engine behind RiskReplay, which runs
+//recorded order flow straight through State, without sockets, shards or
+//journals, to see what other risk limits would have done with it.
+//
+//Recorded flow is read from three kinds of file:
+//- Journals written with --journal. They only hold the orders the server
+//  accepted, so they can show what tighter limits reject but not what looser
+//  ones would have let through.
+//- Wire captures: the raw Header-framed byte stream a client sent, such as one
+//  extracted from a packet capture. A Logon in the stream switches the session.
+//- JSON lines, one message per line, e.g.
+//  {"type":"new","session":1,"instrument":7,"order_id":1,"qty":10,"price":100,"side":"B"}
+//  with types new, delete, modify (qty is the new quantity), trade (with
+//  trade_id) and cancel_all. Fields left out are 0; unknown fields are ignored.
+//
+//Every file is parsed once into memory. Each configuration of limits keeps
+//States of its own, and the configurations are split evenly over a pool of
+//threads; each thread walks the flow once, applying every message to all of
+//its configurations. The limits apply to every session, replacing the
+//thresholds it was configured with.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "order.h"
+#include "risk_checks.h"
+
+//One recorded message, applied to `session_id`'s State
+struct ReplayMessage {
+    //Not a wire message: cancels every resting order of the session, as in the journal
+    static constexpr uint16_t CANCEL_ALL = 0;
+
+    uint64_t session_id;
+    uint16_t message_type;
+    union {
+        NewOrder new_order;
+        DeleteOrder delete_order;
+        ModifyOrderQty modify_order;
+        Trade trade;
+    };
+};
+
+//Appends the messages of a journal, wire capture or JSON lines file, telling
+//them apart by their first bytes. Returns false if the file cannot be read or
+//holds a malformed message.
+bool load_replay_file(const std::string& path, std::vector<ReplayMessage>& messages);
+
+bool load_journal(const std::string& path, std::vector<ReplayMessage>& messages);
+bool load_wire_capture(const std::string& path, std::vector<ReplayMessage>& messages);
+bool load_json_lines(const std::string& path, std::vector<ReplayMessage>& messages);
+
+//Parses one JSON line. Returns false if it is not a message.
+bool parse_replay_json(const std::string& line, ReplayMessage& message);
+
+//Parses limits like "buy=25,sell=20,order-qty=100". A value may be a range
+//"<first>:<last>:<step>", and every combination of the ranges is appended.
+//Keys: buy, sell, order-qty, notional, collar, account-position, account-notional.
+bool parse_limits_spec(const std::string& spec, std::vector<RiskLimits>& configs);
+
+//The limits as parse_limits_spec() takes them, leaving out the disabled ones
+std::string format_limits(const RiskLimits& limits);
+
+//Outcome of new orders and modifies on one instrument
+struct ReplayCounts {
+    uint64_t new_accepted = 0;
+    uint64_t new_rejected = 0;
+    uint64_t modify_accepted = 0;
+    uint64_t modify_rejected = 0;
+};
+
+struct ReplayResult {
+    std::unordered_map<uint64_t, ReplayCounts> instruments;
+    ReplayCounts total;
+    uint64_t deletes = 0;
+    uint64_t trades = 0;
+    uint64_t unknown_orders = 0; //Deletes and modifies of orders that were not resting
+    double seconds = 0;
+};
+
+//Replays every message under one configuration
+ReplayResult replay(const std::vector<ReplayMessage>& messages, const RiskLimits& limits, size_t max_orders);
+
+//Replays every message under each configuration. The configurations are split over
+//`threads` threads, each making a single pass. Results are in the order of `configs`.
+std::vector<ReplayResult> replay_all(const std::vector<ReplayMessage>& messages, const std::vector<RiskLimits>& configs,
+                                     size_t max_orders, size_t threads);
+
+#endif //REPLAY_H_
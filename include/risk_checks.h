@@ -0,0 +1,95 @@
+//risk_checks.h
+//
+//This header file defines the pre-trade risk checks a State runs on every
+//NewOrder and ModifyOrderQty, and RiskCheckList, which composes them at compile
+//time.
+//
+//A check is a struct with a static passes(limits, input) function. Every check
+//in a RiskCheckList is inlined into one function that ANDs their results with
+//no short-circuit, so adding a check adds a few compares and no branch or
+//virtual call. Checks whose limit is zero pass, which lets one build serve
+//sessions with and without the optional limits.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef RISK_CHECKS_H_
+#define RISK_CHECKS_H_
+
+#include <algorithm>
+#include <cstdint>
+
+struct RiskLimits {
+    int64_t max_buy_position = 0;
+    int64_t max_sell_position = 0;
+    uint64_t max_order_qty = 0;     //Largest single order; 0 disables the check
+    uint64_t max_notional = 0;      //Largest order_qty * order_price; 0 disables the check
+    uint64_t price_collar_bps = 0;  //Furthest an order price may be from the last trade, in basis points; 0 disables the check
+
+    //Account-wide limits over every instrument, kept by State rather than a check; 0 disables each
+    int64_t max_account_position = 0; //Sum of each instrument's worst position, buy or sell
+    int64_t max_account_notional = 0; //Sum of order_qty * order_price over the resting orders
+};
+
+//What a check sees: the order being added or modified, and the instrument's
+//quantities as they would be if it were accepted
+struct RiskCheckInput {
+    char side;                //'B' for buy, 'S' for sell
+    uint64_t order_qty;
+    uint64_t order_price;
+    int64_t net_position;
+    int64_t buy_qty;          //Including the order
+    int64_t sell_qty;         //Including the order
+    uint64_t reference_price; //Price of the instrument's last trade, 0 before the first one
+};
+
+//The hypothetical worst position of the side being changed stays within its threshold
+struct WorstPositionCheck {
+    static bool passes(const RiskLimits& limits, const RiskCheckInput& input) {
+        int64_t buy_side = std::max(input.buy_qty, input.net_position + input.buy_qty);
+        int64_t sell_side = std::max(input.sell_qty, input.sell_qty - input.net_position);
+        return !((input.side == 'B') & (buy_side > limits.max_buy_position)) &
+               !((input.side == 'S') & (sell_side > limits.max_sell_position));
+    }
+};
+
+struct MaxOrderQtyCheck {
+    static bool passes(const RiskLimits& limits, const RiskCheckInput& input) {
+        return (limits.max_order_qty == 0) | (input.order_qty <= limits.max_order_qty);
+    }
+};
+
+struct NotionalCheck {
+    static bool passes(const RiskLimits& limits, const RiskCheckInput& input) {
+        uint64_t notional;
+        bool overflow = __builtin_mul_overflow(input.order_qty, input.order_price, &notional);
+        return (limits.max_notional == 0) | (!overflow & (notional <= limits.max_notional));
+    }
+};
+
+//Passes until the instrument has traded, as there is nothing to collar against yet
+struct PriceCollarCheck {
+    static bool passes(const RiskLimits& limits, const RiskCheckInput& input) {
+        uint64_t distance = input.order_price > input.reference_price ? input.order_price - input.reference_price
+                                                                      : input.reference_price - input.order_price;
+        //distance / reference <= bps / 10000, in 128 bits so neither side can overflow
+        unsigned __int128 scaled_distance = static_cast<unsigned __int128>(distance) * 10000;
+        unsigned __int128 allowed = static_cast<unsigned __int128>(input.reference_price) * limits.price_collar_bps;
+        return (limits.price_collar_bps == 0) | (input.reference_price == 0) | (scaled_distance <= allowed);
+    }
+};
+
+template <typename... Checks>
+struct RiskCheckList {
+    static bool passes(const RiskLimits& limits, const RiskCheckInput& input) {
+        return (true & ... & Checks::passes(limits, input));
+    }
+};
+
+//The checks the server runs
+using DefaultRiskChecks = RiskCheckList<WorstPositionCheck, MaxOrderQtyCheck, NotionalCheck, PriceCollarCheck>;
+
+//The position check alone, which is all State did before the other checks existed
+using PositionRiskChecks = RiskCheckList<WorstPositionCheck>;
+
+#endif //RISK_CHECKS_H_
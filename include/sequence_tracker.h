@@ -0,0 +1,174 @@
+//sequence_tracker.h
+//
+//This header file defines the SequenceTracker class, which puts the messages of
+//an unreliable feed back into sequence-number order.
+//
+//A message with the next expected sequence number is delivered at once, together
+//with any later messages that were held back waiting for it. A message ahead of
+//the expected one is held in a fixed window of slots indexed by sequence number,
+//so a reordered datagram costs a copy but no allocation. Messages behind the
+//expected one, or already held, are duplicates and are dropped. When a message
+//arrives too far ahead for the window, or the owner gives up waiting (skip_gap),
+//the missing messages are counted as lost and delivery resumes from the first
+//held message.
+//
+//Sequence numbers are compared modulo 2^32, so a feed may wrap around.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef SEQUENCE_TRACKER_H_
+#define SEQUENCE_TRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class SequenceTracker {
+public:
+    //Largest message that can be held back
+    static constexpr size_t MAX_MESSAGE_SIZE = 64;
+
+    struct Stats {
+        uint64_t received = 0;   //Every message offered
+        uint64_t delivered = 0;
+        uint64_t duplicates = 0; //Dropped: already delivered or already held
+        uint64_t reordered = 0;  //Delivered after being held for an earlier message
+        uint64_t gaps = 0;       //Times delivery skipped over missing messages
+        uint64_t lost = 0;       //Messages skipped over
+        uint64_t oversized = 0;  //Dropped: too large to hold back
+    };
+
+    //`window` is the number of sequence numbers ahead of the expected one that can be
+    //held, rounded up to a power of two so the slots stay aligned when the sequence wraps
+    explicit SequenceTracker(size_t window) {
+        size_t size = 1;
+        while (size < window) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = static_cast<uint32_t>(size - 1);
+    }
+
+    //Offers a message. deliver(sequence, data, size) is called for every message
+    //that is now in order, this one included if it was the expected one.
+    template <typename Deliver>
+    void on_message(uint32_t sequence, const char* data, size_t size, Deliver&& deliver);
+
+    //Gives up on the missing messages before the first held one and delivers from there
+    template <typename Deliver>
+    void skip_gap(Deliver&& deliver);
+
+    //True while messages are held back waiting for a missing one
+    bool has_gap() const { return held_ > 0; }
+
+    uint32_t expected() const { return expected_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        bool used = false;
+        uint32_t sequence = 0;
+        uint32_t size = 0;
+        char data[MAX_MESSAGE_SIZE];
+    };
+
+    std::vector<Slot> slots_;
+    uint32_t mask_ = 0;
+    size_t held_ = 0;
+    bool started_ = false;
+    uint32_t expected_ = 0;
+    Stats stats_;
+
+    Slot& slot_for(uint32_t sequence) { return slots_[sequence & mask_]; }
+
+    //Delivers the held messages that directly follow the expected one
+    template <typename Deliver>
+    void deliver_held(Deliver& deliver);
+};
+
+template <typename Deliver>
+void SequenceTracker::on_message(uint32_t sequence, const char* data, size_t size, Deliver&& deliver) {
+    ++stats_.received;
+    if (!started_) {
+        //The feed starts wherever the first message says it does
+        started_ = true;
+        expected_ = sequence;
+    }
+
+    int32_t ahead = static_cast<int32_t>(sequence - expected_);
+
+    //Too far ahead to hold: give up on the oldest gaps until it fits the window
+    while (ahead > 0 && static_cast<size_t>(ahead) >= slots_.size()) {
+        if (held_ == 0) {
+            ++stats_.gaps;
+            stats_.lost += static_cast<uint32_t>(ahead);
+            expected_ = sequence;
+            ahead = 0;
+            break;
+        }
+        skip_gap(deliver);
+        ahead = static_cast<int32_t>(sequence - expected_);
+    }
+
+    if (ahead < 0) {
+        ++stats_.duplicates;
+        return;
+    }
+    if (ahead == 0) {
+        deliver(sequence, data, size);
+        ++stats_.delivered;
+        ++expected_;
+        deliver_held(deliver);
+        return;
+    }
+
+    Slot& slot = slot_for(sequence);
+    if (slot.used) {
+        ++stats_.duplicates;
+        return;
+    }
+    if (size > MAX_MESSAGE_SIZE) {
+        ++stats_.oversized;
+        return;
+    }
+    slot.used = true;
+    slot.sequence = sequence;
+    slot.size = static_cast<uint32_t>(size);
+    memcpy(slot.data, data, size);
+    ++held_;
+}
+
+template <typename Deliver>
+void SequenceTracker::skip_gap(Deliver&& deliver) {
+    if (held_ == 0) {
+        return;
+    }
+    uint32_t sequence = expected_;
+    while (!slot_for(sequence).used) {
+        ++sequence;
+    }
+    ++stats_.gaps;
+    stats_.lost += static_cast<uint32_t>(sequence - expected_);
+    expected_ = sequence;
+    deliver_held(deliver);
+}
+
+template <typename Deliver>
+void SequenceTracker::deliver_held(Deliver& deliver) {
+    while (held_ > 0) {
+        Slot& slot = slot_for(expected_);
+        if (!slot.used) {
+            return;
+        }
+        slot.used = false;
+        --held_;
+        deliver(slot.sequence, static_cast<const char*>(slot.data), static_cast<size_t>(slot.size));
+        ++stats_.delivered;
+        ++stats_.reordered;
+        ++expected_;
+    }
+}
+
+#endif //SEQUENCE_TRACKER_H_
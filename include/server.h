@@ -3,38 +3,228 @@
 //This file declares the RiskServer class, which manages the network operations,
 //client connections, and message handling for the risk management server.
 //
+//Connections are served by a fixed set of event-loop threads. Every socket is
+//non-blocking and registered edge-triggered with epoll, so one thread can
+//multiplex any number of gateway connections. The first loop accepts every
+//connection and deals them out round-robin, or with --accept reuseport each
+//loop has listeners of its own on both ports, bound as a SO_REUSEPORT group,
+//and the kernel spreads new connections across them. With --io-backend uring each
+//loop drives an io_uring instead: multishot accepts and receives keep
+//completing without being resubmitted, received bytes land in a provided
+//buffer ring, and the sends of a whole round are submitted together with the
+//next wait, so a loop round costs a single io_uring_enter.
+//
+//Responses are not sent one by one: they collect in their connection's output
+//buffer and every connection that has any is flushed with a single send() once the
+//loop has handled all the events of an epoll_wait round, so a burst of pipelined
+//orders is answered in a few large writes while a lone order still goes out at
+//the end of the round that produced it.
+//
+//Gateways on the same host can skip TCP altogether: every segment named with
+//--shm gets a thread of its own that polls the segment's request ring and
+//treats the gateway attached to it as one more order connection.
+//
+//Trades can also arrive on a UDP feed (--trade-feed), read by the first loop
+//and applied in sequence-number order; see TradeFeed.
+//
+//Each connection acts for a session (see ShardPool), so a client that reconnects
+//finds its book as it left it and other clients are not affected at all.
+//
+//With --busy-poll no thread ever sleeps: the loops poll epoll, the ring or
+//their segment without blocking, pick up responses straight from the shard
+//pool instead of through its eventfd, and the sockets busy-poll the NIC
+//(SO_BUSY_POLL). Together with --io-cores, --shard-cores and --sched-fifo this
+//trades whole cores for the lowest wakeup latency.
+//
 //Author: Nikas Zilinskis
 //Date: 19/06/2024
 
 #ifndef SERVER_H_
 #define SERVER_H_
 
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <netinet/in.h>
 #include <string>
 #include <sys/socket.h>
+#include <thread>
 #include <unistd.h>
+#include <unordered_map>
+#include <vector>
 
-#include "state.h"
+#include "config.h"
+#include "message_view.h"
+#include "recv_buffer.h"
+#include "shard_pool.h"
+#include "shm_ring.h"
+#include "trade_feed.h"
+#ifdef RISK_IO_URING
+#include "uring.h"
+#endif
 
 class RiskServer {
 public:
     RiskServer(int max_buy_position, int max_sell_position);
+    explicit RiskServer(const ServerConfig& config);
+    ~RiskServer();
 
     bool init();
     void run();
+    void stop();
     void clear_screen();
 
 private:
-    State state_;
-    int order_socket_;
-    int trade_socket_;
+    struct EventLoop;
+    struct Connection;
+
+    //Indexed by MESSAGE_TYPE; each kind of port has its own table of accepted messages
+    using MessageHandler = void (RiskServer::*)(const char* message, Connection& connection);
+    using MessageTable = DispatchTable<MessageHandler>;
+
+    static const MessageTable ORDER_PORT_MESSAGES;
+    static const MessageTable TRADE_PORT_MESSAGES;
+    static const MessageTable TRADE_FEED_MESSAGES;
+
+    //Everything registered with an epoll instance points back to one of these
+    struct Connection {
+        enum class Kind {
+            ORDER_LISTENER,
+            TRADE_LISTENER,
+            WAKEUP,
+            RESPONSES,
+            SIGNAL,
+            CLIENT,
+            GATEWAY,
+            TRADE_FEED,
+            FEED_TIMER,
+        };
+
+        Connection() = default;
+        Connection(int socket, Kind kind, bool is_trade_socket, EventLoop* loop)
+            : socket(socket), kind(kind), is_trade_socket(is_trade_socket), loop(loop) {}
+
+        int socket = -1;
+        Kind kind = Kind::CLIENT;
+        bool is_trade_socket = false;
+        EventLoop* loop = nullptr;
+        uint64_t id = 0;            //Tags the requests this connection sends to the shards
+        uint64_t session_id = 0;    //Whose State its messages apply to
+        bool logged_on = false;     //A connection can log on only once
+        const MessageTable* messages = nullptr; //What its port accepts
+        uint64_t recv_tsc = 0;      //When the bytes being processed were received
+        RecvBuffer recv_buffer;     //Frames the incoming byte stream
+        std::string pending_output; //Responses batched for the next flush, or refused by the kernel
+        bool flush_queued = false;  //Listed in the loop's unflushed connections
+        bool awaiting_writable = false; //The kernel buffer is full; EPOLLOUT will flush
+
+        //io_uring only: the kernel may still use the connection after it is closed
+        std::string inflight_output; //Bytes of the send in flight
+        bool send_in_flight = false;
+        bool recv_armed = false;     //The multishot receive is still active
+        bool closing = false;
+        int pending_ops = 0;         //Submitted operations not yet completed
+    };
+
+    struct EventLoop {
+        size_t index = 0;      //Also this loop's producer index in the shard pool
+        int epoll_fd = -1;
+        int wakeup_fd = -1;
+        Connection wakeup;
+        Connection responses;  //Readable when the shards have responses for this loop
+        Connection order_listener; //Only on the first loop, or on every socket loop with --accept reuseport
+        Connection trade_listener;
+        bool listening = false;
+        FutexDoorbell response_doorbell; //Rung instead of `responses` when busy polling; nobody sleeps on it
+        int core = -1;         //Pinned to this core, from --io-cores
+        std::thread thread;
+
+        //Written on accept and close, read per response; the lock is uncontended
+        //unless a connection is being accepted for this loop
+        std::mutex connections_mutex;
+        std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+
+        //Connections with batched responses, flushed at the end of the round
+        std::vector<Connection*> unflushed;
+
+        //Syscalls made for network I/O and messages received, for the latency report
+        std::atomic<uint64_t> syscalls{0};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> accepted{0}; //Connections handed to this loop
+
+        //Set when the loop serves a shared-memory gateway instead of sockets
+        std::unique_ptr<ShmSegment> gateway;
+
+#ifdef RISK_IO_URING
+        std::unique_ptr<IoUring> ring; //Set when the loop runs on io_uring
+
+        //Accepted by the first loop, waiting for this loop to start receiving
+        std::mutex new_clients_mutex;
+        std::vector<Connection*> new_clients;
+
+        //Closed, but kept alive until their operations complete
+        std::unordered_map<Connection*, std::unique_ptr<Connection>> retired;
+#endif
+    };
+
+    ServerConfig config_;
+    std::unique_ptr<ShardPool> shards_;
     int response_socket_;
 
-    bool setup_socket(int& socket, int port);
-    void handle_client(int client_socket, bool is_trade_socket);
-    void process_message(const char* buffer, size_t size, int client_socket, bool is_trade_socket);
-    void send_response(int client_socket, const OrderResponse& response);
+    Connection signal_;         //SIGUSR1 asks for a latency report, SIGUSR2 for a snapshot
+    std::unique_ptr<TradeFeed> trade_feed_;
+    Connection trade_feed_connection_;
+    Connection feed_timer_;     //Fires when a missing feed trade has been waited for long enough
+    bool feed_timer_armed_ = false;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::atomic<bool> running_{false};
+    size_t socket_loops_ = 0; //loops_ before the gateway loops
+    size_t next_loop_ = 0;
+    bool busy_poll_warned_ = false;
+    std::atomic<uint64_t> next_connection_id_{1};
+
+    bool setup_socket(int& socket, int port, bool reuse_port);
+    bool setup_listeners();
+    void set_busy_poll(int socket);
+    bool setup_event_loops();
+    bool setup_trade_feed(EventLoop& loop);
+    void read_trade_feed(Connection& connection);
+    void skip_trade_feed_gap(Connection& timer);
+    void arm_feed_timer();
+    void run_event_loop(EventLoop& loop);
+    void accept_clients(const Connection& listener);
+    void add_client(const Connection& listener, int client_socket);
+    void handle_signals(Connection& signal);
+    bool read_client(Connection& connection);
+    bool process_frames(Connection& connection);
+    bool flush_output(Connection& connection);
+    void watch_writable(Connection& connection, bool writable);
+    void write_output(Connection& connection);
+    void flush_responses(EventLoop& loop);
+    void close_client(Connection* connection);
+    void process_message(const char* buffer, size_t size, Connection& connection);
+    template <typename Message>
+    void handle_message(const char* message, Connection& connection);
+    void submit_request(Connection& connection, ShardRequest& request, uint64_t order_id);
+    void report_latency();
+    void drain_responses(EventLoop& loop);
+    void send_response(Connection& connection, const OrderResponse& response);
+    void run_gateway_loop(EventLoop& loop);
+    Connection* open_gateway_client(EventLoop& loop);
+    void write_gateway_output(Connection& connection);
+
+#ifdef RISK_IO_URING
+    bool setup_uring();
+    void run_uring_loop(EventLoop& loop);
+    void handle_completion(EventLoop& loop, const io_uring_cqe& cqe);
+    void handle_client_completion(EventLoop& loop, Connection& connection, uint64_t operation,
+                                  const io_uring_cqe& cqe);
+    void start_clients(EventLoop& loop);
+    void start_client(EventLoop& loop, Connection& connection);
+    void retire_client(EventLoop& loop, std::unique_ptr<Connection> owner);
+    void release_if_idle(EventLoop& loop, Connection& connection);
+#endif
 };
 
-#endif 
\ No newline at end of file
+#endif
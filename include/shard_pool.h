@@ -0,0 +1,286 @@
+//shard_pool.h
+//
+//This file declares the ShardPool class, which partitions the risk state by
+//instrument across a set of worker threads.
+//
+//Every shard owns a private State instance per session and is the only thread
+//that ever touches them, so no locking is needed on the risk path. A session is
+//one client's book: it has its own thresholds and resting orders and outlives its
+//connections. Sessions and their thresholds are configured on the server, and a
+//Logon message only picks one (session 0 holds the server-wide defaults and
+//serves connections that never log on). The I/O threads feed the
+//shards through lock-free SPSC queues (one per I/O thread and shard pair) and the
+//shards hand OrderResponses back the same way, tagged with the connection that
+//sent the request. The position thresholds are per session; the per-order
+//limits of RiskLimits (size, notional, price collar) apply to every session
+//alike. The account limits span a session's States on every shard, which share
+//the session's AccountExposure. NewOrders and Trades are routed by instrument ID; deletes and
+//modifies carry only an order ID, so they are routed through a shared order
+//index that remembers which shard each (session, order ID) was sent to.
+//
+//With journaling enabled every shard records the messages that changed its State
+//and writes them out before the responses of the batch are released. Snapshots
+//are taken by the shards between batches and written out by a background thread.
+//
+//With a position board open, every shard republishes an instrument's counters
+//after each message that changed them, into the slot it claimed for that
+//(session, instrument).
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef SHARD_POOL_H_
+#define SHARD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "journal.h"
+#include "order.h"
+#include "position_board.h"
+#include "shm_ring.h"
+#include "snapshot.h"
+#include "spsc_queue.h"
+#include "state.h"
+
+//A message on its way from an I/O thread to a shard
+struct ShardRequest {
+    //Not a wire message: asks the shard to cancel every resting order of the session
+    static constexpr uint16_t CANCEL_ALL = 0;
+
+    uint64_t connection_id; //Routes the response back to the sender
+    uint64_t session_id;    //Whose State the message applies to
+    uint64_t recv_tsc;      //When the message was read from the socket
+    uint64_t submit_tsc;    //When it was queued for the shard
+    uint16_t message_type;
+    union {
+        NewOrder new_order;
+        DeleteOrder delete_order;
+        ModifyOrderQty modify_order;
+        Trade trade;
+    };
+};
+
+//A response on its way from a shard back to the connection's I/O thread
+struct ShardResponse {
+    uint64_t connection_id;
+    uint64_t recv_tsc;     //Copied from the request
+    uint64_t respond_tsc;  //When the shard finished the check
+    uint16_t message_type; //Of the request being answered
+    OrderResponse response;
+};
+
+class ShardPool {
+public:
+    //Shard i is pinned to cores[i] when given, otherwise left to the scheduler
+    //`limits` holds session 0's thresholds and the per-order limits of every session
+    ShardPool(size_t shard_count, size_t producer_count, const RiskLimits& limits, size_t max_orders,
+              const std::vector<int>& cores = {});
+    ~ShardPool();
+
+    ShardPool(const ShardPool&) = delete;
+    ShardPool& operator=(const ShardPool&) = delete;
+
+    //Loads each shard's snapshot from `directory`, replays the journal after it and
+    //keeps appending to the journal. Snapshots are then taken every
+    //`snapshot_interval_s` seconds (0 for only on request). Call before start().
+    //Returns false if a journal or snapshot cannot be used.
+    bool open_journals(const std::string& directory, JournalSync sync, int sync_interval_ms,
+                       int snapshot_interval_s);
+
+    //Asks every journaled shard to write a snapshot after its current batch
+    void request_snapshot();
+
+    //Publishes the live instrument counters to /dev/shm/<name>, with room for
+    //`capacity` instruments. Call before start(). Returns false if it cannot be created.
+    bool open_position_board(const std::string& name, size_t capacity);
+
+    //Lets clients log on to `session_id`, which is held to these position limits.
+    //Call before open_journals().
+    void add_session(uint64_t session_id, int64_t max_buy_position, int64_t max_sell_position);
+
+    //Returns false if the session was not configured with add_session()
+    bool logon(uint64_t session_id);
+
+    //Counts the order connections of a session. detach() returns true when the last one leaves.
+    void attach(uint64_t session_id);
+    bool detach(uint64_t session_id);
+
+    //Runs the shard workers SCHED_FIFO at `fifo_priority` (0 leaves them SCHED_OTHER) and,
+    //with `busy_poll`, keeps them spinning when idle instead of sleeping. Call before start().
+    void set_scheduling(int fifo_priority, bool busy_poll);
+
+    void start();
+    void stop();
+
+    //Picks the shard for a request. Returns false when the request can be rejected
+    //straight away: an unknown order ID, or a NewOrder reusing a resting order ID.
+    bool route(const ShardRequest& request, size_t& shard);
+
+    //Queues a routed request from I/O thread `producer`. Returns false when the queue is full.
+    bool try_submit(size_t producer, size_t shard, const ShardRequest& request);
+
+    //Becomes readable when responses for I/O thread `producer` are waiting
+    int response_fd(size_t producer) const;
+
+    //Wakes `producer` by ringing `doorbell` instead of writing its response_fd. Call before start().
+    void set_response_doorbell(size_t producer, FutexDoorbell* doorbell);
+
+    //True while responses for `producer` may be waiting to be drained
+    bool responses_waiting(size_t producer) const { return producers_[producer]->notified.load(); }
+
+    //Hands every waiting response for I/O thread `producer` to the handler
+    template <typename Handler>
+    size_t drain_responses(size_t producer, Handler&& handler);
+
+    size_t shard_count() const { return shards_.size(); }
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+    static constexpr size_t ROUTER_STRIPES = 64;
+
+    //An instrument of one session
+    struct InstrumentKey {
+        uint64_t session_id;
+        uint64_t instrument_id;
+
+        bool operator==(const InstrumentKey& other) const {
+            return session_id == other.session_id && instrument_id == other.instrument_id;
+        }
+    };
+
+    struct InstrumentKeyHash {
+        size_t operator()(const InstrumentKey& key) const {
+            return key.instrument_id * 0x9E3779B97F4A7C15ULL ^ key.session_id;
+        }
+    };
+
+    struct Shard {
+        explicit Shard(size_t index) : index(index) {}
+
+        size_t index;
+        std::unordered_map<uint64_t, std::unique_ptr<State>> sessions; //Created on first use
+        uint64_t last_session_id = 0; //Most messages in a batch come from the same session
+        State* last_session = nullptr;
+        int core = -1;
+        std::thread thread;
+        std::atomic<uint32_t> doorbell{0}; //Bumped by producers so an idle shard can sleep
+        std::vector<std::unique_ptr<SpscQueue<ShardRequest>>> requests;   //One per producer
+        std::vector<std::unique_ptr<SpscQueue<ShardResponse>>> responses; //One per producer
+        std::vector<char> responded; //Producers that got responses in the current batch
+        std::unique_ptr<Journal> journal;
+        std::vector<std::pair<size_t, ShardResponse>> held_responses; //Waiting for the journal write
+        std::atomic<bool> snapshot_requested{false};
+        std::atomic<bool> snapshot_in_flight{false}; //The writer owns `snapshot` while set
+        SnapshotData snapshot;
+        std::unordered_map<InstrumentKey, PositionSlot*, InstrumentKeyHash> position_slots; //Null when the board was full
+    };
+
+    struct Producer {
+        int response_fd = -1;
+        FutexDoorbell* doorbell = nullptr; //Replaces response_fd when set
+        std::atomic<bool> notified{false}; //Set while a wakeup is outstanding
+    };
+
+    //Order IDs are only unique within a session
+    struct RouteKey {
+        uint64_t session_id;
+        uint64_t order_id;
+
+        bool operator==(const RouteKey& other) const {
+            return session_id == other.session_id && order_id == other.order_id;
+        }
+    };
+
+    struct RouteKeyHash {
+        size_t operator()(const RouteKey& key) const {
+            return key.order_id * 0x9E3779B97F4A7C15ULL ^ key.session_id;
+        }
+    };
+
+    //(session, order ID) to shard, striped so the I/O threads rarely contend
+    struct RouterStripe {
+        std::mutex mutex;
+        std::unordered_map<RouteKey, size_t, RouteKeyHash> shards;
+    };
+
+    struct Session {
+        int64_t max_buy_position;
+        int64_t max_sell_position;
+        size_t connections = 0;
+        std::shared_ptr<AccountExposure> account = std::make_shared<AccountExposure>(); //Shared by every shard
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<std::unique_ptr<Producer>> producers_;
+    RouterStripe router_[ROUTER_STRIPES];
+    std::atomic<bool> running_{false};
+    int fifo_priority_ = 0;
+    bool busy_poll_ = false; //Shards never sleep, so producers need not ring them
+    RiskLimits limits_;
+    size_t max_orders_;
+    bool recovering_ = false; //open_journals() is replaying, with the account limits suspended
+
+    //Every configured session; session 0 is always present with the server defaults
+    std::mutex sessions_mutex_;
+    std::unordered_map<uint64_t, Session> sessions_;
+
+    //Snapshot writer
+    std::string journal_dir_;
+    int snapshot_interval_s_ = 0;
+    std::thread snapshot_thread_;
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    std::vector<Shard*> snapshot_queue_;
+    bool snapshot_stop_ = false;
+
+    std::unique_ptr<PositionBoard> position_board_;
+
+    size_t shard_for_instrument(uint64_t instrument_id) const;
+    RouterStripe& stripe_for(uint64_t order_id);
+    void remember_order(uint64_t session_id, uint64_t order_id, size_t shard);
+    void forget_order(uint64_t session_id, uint64_t order_id);
+    State& session_state(Shard& shard, uint64_t session_id);
+    void cancel_all_orders(Shard& shard, uint64_t session_id);
+    bool load_snapshot(size_t shard, const std::string& path, size_t& journal_offset);
+    std::string shard_path(size_t shard, const char* extension) const;
+    void replay_record(size_t shard, const JournalRecordHeader& record, const char* payload, size_t& skipped);
+
+    void run_shard(Shard& shard);
+    void handle_request(Shard& shard, size_t producer, const ShardRequest& request);
+    //Answers a request without applying it, once the shard's journal has failed
+    void reject_unjournaled(Shard& shard, size_t producer, const ShardRequest& request);
+    void respond(Shard& shard, size_t producer, const ShardRequest& request, uint64_t order_id, bool accepted);
+    void push_response(Shard& shard, size_t producer, const ShardResponse& response);
+    void release_responses(Shard& shard);
+    void notify_producers(Shard& shard);
+    void take_snapshot(Shard& shard);
+    void publish_position(Shard& shard, uint64_t session_id, const State& state, uint64_t instrument_id);
+    void publish_session(Shard& shard, uint64_t session_id, const State& state);
+    void run_snapshot_writer();
+};
+
+template <typename Handler>
+size_t ShardPool::drain_responses(size_t producer, Handler&& handler) {
+    //Clear the flag before draining, so a response pushed meanwhile triggers a new wakeup
+    producers_[producer]->notified.store(false);
+
+    size_t drained = 0;
+    ShardResponse response;
+    for (auto& shard : shards_) {
+        while (shard->responses[producer]->try_pop(response)) {
+            handler(response);
+            ++drained;
+        }
+    }
+    return drained;
+}
+
+#endif //SHARD_POOL_H_
@@ -0,0 +1,59 @@
+//shm_client.h
+//
+//This header file defines ShmClient, the shared-memory counterpart of Client for
+//gateways on the same host as the RiskServer.
+//
+//It attaches to one of the segments the server was started with (--shm) and
+//exchanges the same Header-framed messages and OrderResponses as a TCP order
+//connection, with the same semantics, through the segment's rings instead of
+//the loopback stack. A segment serves one gateway at a time; disconnecting
+//frees it for the next, exactly like closing the TCP connection.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef SHM_CLIENT_H_
+#define SHM_CLIENT_H_
+
+#include <string>
+#include <sys/types.h>
+
+#include "order.h"
+#include "shm_ring.h"
+
+class ShmClient {
+public:
+    //`wait` decides how the client waits for responses
+    explicit ShmClient(const std::string& name, ShmWait wait = ShmWait::SPIN);
+    ~ShmClient();
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    //Maps the segment and claims it. Fails if the server is not running or another gateway holds it.
+    bool connect_to_server();
+
+    //Releases the segment; the server treats this like a closed connection
+    void disconnect();
+
+    //Sends one or more complete Header-framed messages, waiting while the ring is full
+    bool send_message(const char* message, size_t size);
+
+    //Waits for the next response and copies up to `size` bytes of it into `buffer`.
+    //Returns false, and disconnects, if the server exits while it waits.
+    bool receive_response(char* buffer, size_t size);
+
+    //Copies the responses that are already waiting, as many as fit whole. Returns the
+    //bytes copied, 0 if nothing is waiting, or -1 when not connected.
+    ssize_t receive_some(char* buffer, size_t size);
+
+private:
+    ShmSegment segment_;
+    std::string name_;
+    ShmWait wait_;
+    bool connected_ = false;
+
+    bool server_running() const;
+};
+
+#endif //SHM_CLIENT_H_
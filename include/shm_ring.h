@@ -0,0 +1,158 @@
+//shm_ring.h
+//
+//This header file declares the shared-memory transport used by gateways that
+//run on the same host as the RiskServer.
+//
+//Each gateway gets its own segment in /dev/shm holding two single-producer,
+//single-consumer rings: requests from the gateway to the server and responses
+//back. A slot carries exactly the bytes the TCP stream would: a Header and its
+//message on the way in, an OrderResponse on the way out. Like SpscQueue, each
+//side writes only its own index, on its own cache line, and keeps a cached copy
+//of the other side's.
+//
+//A consumer either spins on its ring or sleeps on the ring's FutexDoorbell. The
+//doorbell is a shared (not process-private) futex, so the producer's ring() can
+//wake a consumer in another process, and it costs no syscall while nobody sleeps.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef SHM_RING_H_
+#define SHM_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+//How a consumer waits for an empty ring to fill
+enum class ShmWait {
+    SPIN,  //Poll continuously; lowest latency, burns the core
+    FUTEX, //Sleep in the kernel until the producer rings the doorbell
+};
+
+//Parses "spin" or "futex"
+bool parse_shm_wait(const char* text, ShmWait& wait);
+
+struct FutexDoorbell {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> sleepers{0};
+
+    //Producer side, after publishing: wakes the consumer if it sleeps
+    void ring();
+
+    //Consumer side: sleeps until ring() or `timeout_ms`, unless ready() says
+    //there is already work. Returns ready() as seen before sleeping.
+    template <typename Ready>
+    bool wait(Ready&& ready, int timeout_ms);
+
+private:
+    void sleep(uint32_t seen, int timeout_ms);
+};
+
+class ShmRing {
+public:
+    static constexpr size_t SLOT_COUNT = 4096;
+    static constexpr size_t SLOT_DATA = 60;
+
+    struct Slot {
+        uint32_t size;
+        char data[SLOT_DATA];
+    };
+
+    //Producer side. Returns false when the ring is full or the message does not fit a slot.
+    bool try_push(const char* data, size_t size);
+
+    //Consumer side: the oldest slot, or null when the ring is empty. The slot
+    //stays valid until pop(), so it can be processed in place.
+    const Slot* front();
+    void pop();
+
+    //Only exact from the consumer
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    //Consumer sleeps here; the producer rings it after each push
+    FutexDoorbell& doorbell() { return doorbell_; }
+
+    //Empties the ring. Only while neither side is using it.
+    void reset();
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0}; //Written by the consumer
+    uint64_t cached_tail_ = 0;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0}; //Written by the producer
+    uint64_t cached_head_ = 0;
+
+    alignas(CACHE_LINE) FutexDoorbell doorbell_;
+
+    alignas(CACHE_LINE) Slot slots_[SLOT_COUNT];
+};
+
+static_assert(sizeof(ShmRing::Slot) == 64, "ShmRing::Slot size is not 64 bytes");
+
+//The contents of a gateway's segment
+struct ShmGatewayLayout {
+    static constexpr uint32_t MAGIC = 0x47534B52; //"RKSG"
+    static constexpr uint32_t VERSION = 2; //2: the server's PID
+
+    enum State : uint32_t {
+        FREE = 0,     //Waiting for a gateway
+        ATTACHED = 1, //Claimed by the gateway in client_pid
+        CLOSING = 2,  //The gateway left; the server resets the rings and frees the segment
+    };
+
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> client_pid;
+    int32_t server_pid; //Set before the segment is published
+    ShmRing requests;  //Gateway to server; the shards ring its doorbell too
+    ShmRing responses; //Server to gateway
+};
+
+//Maps a gateway segment: created by the server, opened by a gateway
+class ShmSegment {
+public:
+    ShmSegment() = default;
+    ~ShmSegment();
+
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    //Creates /dev/shm/<name>, replacing a stale one, and removes it again on destruction
+    bool create(const std::string& name);
+
+    //Maps an existing segment created by a server of the same layout version
+    bool open(const std::string& name);
+
+    ShmGatewayLayout* layout() const { return layout_; }
+    const std::string& name() const { return name_; }
+
+private:
+    std::string name_;
+    ShmGatewayLayout* layout_ = nullptr;
+    bool owner_ = false;
+};
+
+template <typename Ready>
+bool FutexDoorbell::wait(Ready&& ready, int timeout_ms) {
+    //Announce the sleeper before the last check: a producer publishing after the
+    //check sees it and rings, and one publishing before it is seen by the check
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t seen = sequence.load(std::memory_order_seq_cst);
+    bool has_work = ready();
+    if (!has_work) {
+        sleep(seen, timeout_ms);
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+    return has_work;
+}
+
+#endif //SHM_RING_H_
@@ -0,0 +1,120 @@
+//snapshot.h
+//
+//This header file declares the point-in-time snapshots that bound the restart
+//time of a journaled shard.
+//
+//A snapshot holds, for every session of one shard, the session's limits, its
+//instruments' counters and its resting orders, together with the journal offset
+//it is consistent with. The shard fills a SnapshotData shadow copy between two
+//batches, which is a flat copy of its State and never touches the disk; a
+//background thread then writes it to a temporary file, syncs it and renames it
+//over the previous snapshot, so a crash mid-write leaves the old snapshot intact.
+//On startup the snapshot is mapped with mmap and loaded straight into State, and
+//only the journal records after its offset are replayed.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SnapshotFileHeader {
+    static constexpr uint32_t MAGIC = 0x534B5352; //"RSKS"
+    static constexpr uint16_t VERSION = 3; //2: one section per session, 3: prices for the risk checks
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t shard;
+    uint16_t shard_count;
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint64_t journal_offset; //Journal bytes already reflected in the snapshot
+    uint64_t session_count;
+    uint64_t body_size;      //Bytes of session sections after the header
+    uint64_t checksum;       //Over the session sections
+} __attribute__((__packed__));
+
+static_assert(sizeof(SnapshotFileHeader) == 48, "SnapshotFileHeader size is not 48 bytes");
+
+//Starts each session's section, followed by its instruments and then its orders
+struct SnapshotSession {
+    uint64_t session_id;
+    int64_t max_buy_position;
+    int64_t max_sell_position;
+    uint64_t instrument_count;
+    uint64_t order_count;
+};
+
+static_assert(sizeof(SnapshotSession) == 40, "SnapshotSession size is not 40 bytes");
+
+struct SnapshotInstrument {
+    uint64_t instrument_id;
+    int64_t net_position;
+    int64_t buy_qty;
+    int64_t sell_qty;
+    uint64_t last_trade_price;
+};
+
+static_assert(sizeof(SnapshotInstrument) == 40, "SnapshotInstrument size is not 40 bytes");
+
+struct SnapshotOrder {
+    uint64_t order_id;
+    uint64_t instrument_id;
+    uint64_t order_qty;
+    uint64_t order_price;
+    char side;
+    char reserved[7];
+};
+
+static_assert(sizeof(SnapshotOrder) == 40, "SnapshotOrder size is not 40 bytes");
+
+//Shadow copy of one session's State
+struct SnapshotSessionData {
+    uint64_t session_id = 0;
+    int64_t max_buy_position = 0;
+    int64_t max_sell_position = 0;
+    std::vector<SnapshotInstrument> instruments;
+    std::vector<SnapshotOrder> orders;
+};
+
+//Shadow copy of a shard, reused from one snapshot to the next
+struct SnapshotData {
+    uint64_t journal_offset = 0;
+    size_t session_count = 0; //Sessions in use; later entries keep their storage for reuse
+    std::vector<SnapshotSessionData> sessions;
+};
+
+//Writes a snapshot atomically: to path + ".tmp", synced, then renamed over path
+bool write_snapshot(const std::string& path, uint16_t shard, uint16_t shard_count, const SnapshotData& snapshot);
+
+//Reads a snapshot file through a read-only memory mapping
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    //Maps and validates the file. A missing file is not an error; header() stays null.
+    bool open(const std::string& path);
+
+    const SnapshotFileHeader* header() const { return header_; }
+
+    //Advances to the next session section. Returns false after the last one.
+    bool next_session(const SnapshotSession*& session, const SnapshotInstrument*& instruments,
+                      const SnapshotOrder*& orders);
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+    const SnapshotFileHeader* header_ = nullptr;
+};
+
+#endif //SNAPSHOT_H_
@@ -0,0 +1,84 @@
+//spsc_queue.h
+//
+//This header file defines the SpscQueue class template, a bounded lock-free
+//queue for exactly one producer thread and one consumer thread.
+//
+//The producer only writes tail_ and the consumer only writes head_, each on its
+//own cache line. Both sides keep a cached copy of the other side's index and
+//only reload the shared atomic when the cached value says the queue looks full
+//(or empty), so in steady state a push or pop touches no shared cache line
+//other than the slot itself.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+public:
+    //The capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    //Producer side. Returns false when the queue is full.
+    bool try_push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer side. Returns false when the queue is empty.
+    bool try_pop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        item = buffer_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Safe to call from either side, but only exact from the consumer
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> buffer_;
+    size_t mask_;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0}; //Written by the consumer
+    size_t cached_tail_ = 0;
+
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0}; //Written by the producer
+    size_t cached_head_ = 0;
+};
+
+#endif //SPSC_QUEUE_H_
@@ -4,23 +4,60 @@
 //client's orders and trades, and handles the calculation of the hypothetical
 //worst net position.
 //
+//State runs the default set of pre-trade checks from risk_checks.h. It is an
+//alias for BasicState<DefaultRiskChecks>; BasicState takes any RiskCheckList,
+//and the lists it is built for are instantiated in state.cpp.
+//
+//The account limits need totals over every instrument. Rather than summing them
+//per order, every add, modify, delete and trade works out how it changed its
+//own instrument's worst position and resting notional, and adds just that to
+//an AccountExposure, so the account check is O(1) however many instruments are
+//active. A State given no AccountExposure keeps one of its own.
+//
 //Author: Nikas Zilinskis
 //Date: 19/06/2024
 
 #ifndef STATE_H_
 #define STATE_H_
 
+#include "account_exposure.h"
+#include "flat_hash_map.h"
 #include "order.h"
+#include "order_pool.h"
+#include "risk_checks.h"
+#include "snapshot.h"
 #include <unordered_map>
 #include <cstdint>
 #include <vector>
 #include <algorithm>
 #include <optional>
 
-class State {
+template <typename Checks>
+class BasicState {
 public:
-    State(int64_t buy_threshold, int64_t sell_threshold)
-        : BUY_THRESHOLD(buy_threshold), SELL_THRESHOLD(sell_threshold) {}
+    //Hot counters of one instrument
+    struct Position {
+        int64_t net_position;
+        int64_t buy_qty;
+        int64_t sell_qty;
+    };
+
+    //Resting orders a State can hold unless told otherwise
+    static constexpr size_t DEFAULT_MAX_ORDERS = 65536;
+
+    //All order storage is allocated here, so adding and cancelling orders never allocates.
+    //`account` is shared by the States of one account, one per shard; with none given
+    //the State's own instruments make up the account.
+    BasicState(const RiskLimits& limits, size_t max_orders = DEFAULT_MAX_ORDERS, AccountExposure* account = nullptr);
+
+    //Only the position thresholds; the other limits are disabled
+    BasicState(int64_t buy_threshold, int64_t sell_threshold, size_t max_orders = DEFAULT_MAX_ORDERS);
+
+    //Takes this State's share back out of the account
+    ~BasicState();
+
+    BasicState(const BasicState&) = delete;
+    BasicState& operator=(const BasicState&) = delete;
 
     //Adds a new order to the state if accepted
     bool add_order_if_accepted(const NewOrder& order);
@@ -28,9 +65,15 @@ public:
     //Deletes an order from the state
     bool delete_order(const DeleteOrder& order);
 
+    //Deletes an order and reports the instrument it rested on
+    bool delete_order(const DeleteOrder& order, uint64_t& instrument_id);
+
     //Modifies an existing order's quantity
     bool modify_order_if_accepted(const ModifyOrderQty& order);
 
+    //Modifies an existing order's quantity and reports its instrument
+    bool modify_order_if_accepted(const ModifyOrderQty& order, uint64_t& instrument_id);
+
     //Processes a trade
     void process_trade(const Trade& trade);
 
@@ -43,37 +86,117 @@ public:
     //Prints the state of the instrument
     void print_instrument_state(uint64_t instrument_id) const;
 
+    //Copies the counters of an instrument. Returns false if the instrument is unknown.
+    bool get_position(uint64_t instrument_id, Position& position) const;
+
+    //Calls visit(instrument_id, position) for every instrument the state knows
+    template <typename Visitor>
+    void for_each_position(Visitor&& visit) const {
+        for (const auto& [instrument_id, state] : instrument_states_) {
+            visit(instrument_id, Position{state.net_position, state.buy_qty, state.sell_qty});
+        }
+    }
+
     //Finds the instrument ID by order ID
     std::optional<uint64_t> find_instrument_id_by_order(uint64_t order_id) const;
 
     //Resets the state
     void reset();
 
-private:
-    struct Order {
-        uint64_t order_id;
-        uint64_t order_qty;
-        char side; //'B' for buy, 'S' for sell
-    };
+    //Cancels every resting order but keeps the net positions built up by trades.
+    //Appends the IDs of the cancelled orders to `cancelled`.
+    void cancel_all_orders(std::vector<uint64_t>& cancelled);
+
+    int64_t buy_threshold() const { return LIMITS.max_buy_position; }
+    int64_t sell_threshold() const { return LIMITS.max_sell_position; }
+    const RiskLimits& limits() const { return LIMITS; }
+
+    //This State's share of the account totals. The position is kept while either account
+    //limit is set, the notional only while its own limit is.
+    int64_t exposure_position() const { return exposure_position_; }
+    int64_t exposure_notional() const { return exposure_notional_; }
 
+    //Stops checking and counting the account limits, taking this State's share out of
+    //the account. Recovery replays already accepted messages shard by shard, in another
+    //order than they arrived, so the account checks would refuse some of them.
+    void suspend_account_limits();
+
+    //Counts this State's share again, recomputed from its orders and positions
+    void resume_account_limits();
+
+    //Copies every instrument and resting order into a snapshot, reusing its storage
+    void save_snapshot(SnapshotSessionData& snapshot) const;
+
+    //Replaces the state with a snapshot's contents, without running the risk checks.
+    //Returns false if the orders do not fit the order pool.
+    bool load_snapshot(const SnapshotInstrument* instruments, size_t instrument_count,
+                       const SnapshotOrder* orders, size_t order_count);
+
+private:
     struct InstrumentState {
         int64_t net_position = 0;
         int64_t buy_qty = 0;
         int64_t sell_qty = 0;
-        std::vector<Order> orders;
+        uint32_t orders = OrderPool::NONE; //Head of this instrument's list in the order pool
+        uint32_t order_count = 0;
+        uint64_t last_trade_price = 0; //Reference for the price collar
     };
 
-    const int64_t BUY_THRESHOLD;
-    const int64_t SELL_THRESHOLD;
+    const RiskLimits LIMITS;
+
+    //Maps instrument IDs to their state. The open-addressing table keeps the hot
+    //counters inline in its slot array; the orders themselves live in the pool.
+#ifdef RISK_FLAT_INSTRUMENT_MAP
+    using InstrumentMap = FlatHashMap<InstrumentState>;
+#else
+    using InstrumentMap = std::unordered_map<uint64_t, InstrumentState>;
+#endif
+    InstrumentMap instrument_states_;
+
+    //Storage for every resting order
+    OrderPool orders_;
+
+    //Maps every resting order ID to its node in the pool, so order-keyed operations
+    //are O(1). Sized for the pool up front, so it never rehashes.
+    FlatHashMap<uint32_t> order_index_;
 
-    //Maps instrument IDs to their state
-    std::unordered_map<uint64_t, InstrumentState> instrument_states_;
+    //Account totals, only kept when an account limit is set (account_ is null otherwise)
+    AccountExposure own_account_;
+    AccountExposure* account_;
+    AccountExposure* suspended_account_ = nullptr; //Holds account_ while the limits are suspended
+    int64_t exposure_position_ = 0;
+    int64_t exposure_notional_ = 0;
 
-    //Helper function to find an order
-    std::vector<Order>::iterator find_order(InstrumentState& state, uint64_t order_id);
+    //The larger of an instrument's hypothetical worst buy and sell positions
+    static int64_t worst_position(int64_t net_position, int64_t buy_qty, int64_t sell_qty) {
+        return std::max(std::max(buy_qty, net_position + buy_qty), std::max(sell_qty, sell_qty - net_position));
+    }
 
-    //Helper function to simulate adding an order and calculate hypothetical positions
-    bool simulate_add_order(const NewOrder& order, int64_t& buy_side, int64_t& sell_side) const;
+    //Notional of an order for the account total, 0 without a notional limit. An
+    //overflow saturates, so the order can never fit the limit.
+    int64_t order_notional(uint64_t order_qty, uint64_t order_price) const;
+
+    //Reserves an increase of the account totals. Returns false if it would cross an account limit.
+    bool try_add_exposure(int64_t position_delta, int64_t notional_delta);
+
+    //Applies a change of the account totals that cannot be refused
+    void add_exposure(int64_t position_delta, int64_t notional_delta);
+
+    //Recomputes this State's share from scratch, after a bulk change
+    void rebuild_exposure();
+
+    //Helper function to unlink and free an order, keeping the index in sync
+    void remove_order(InstrumentState& state, uint32_t node);
+
+    //Pure arithmetic pre-trade check: runs every check in Checks against the instrument
+    //as it would be with the given quantities, without touching the state
+    bool passes_checks(const InstrumentState& state, char side, uint64_t order_qty, uint64_t order_price,
+                       int64_t buy_qty, int64_t sell_qty) const;
 };
 
+extern template class BasicState<DefaultRiskChecks>;
+extern template class BasicState<PositionRiskChecks>;
+
+using State = BasicState<DefaultRiskChecks>;
+
 #endif 
@@ -0,0 +1,118 @@
+//trade_feed.h
+//
+//This header file declares TradeFeed, which ingests Trade messages from a UDP
+//drop-copy feed, multicast or unicast, as an alternative to the TCP trade port.
+//
+//Every datagram carries one or more Header-framed Trades, and each Header's
+//sequence_number numbers the feed. Datagrams are read in batches with a single
+//recvmmsg() call and their trades are put back into sequence order by a
+//SequenceTracker, so gaps, duplicates and reordering from the network are
+//counted rather than applied. Several risk instances can bind the same multicast
+//group and port, each receiving every datagram; a unicast feed needs a port per
+//instance.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef TRADE_FEED_H_
+#define TRADE_FEED_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+#include "order.h"
+#include "sequence_tracker.h"
+
+class TradeFeed {
+public:
+    //Datagrams read per recvmmsg() call, and the largest one accepted
+    static constexpr size_t BATCH = 64;
+    static constexpr size_t MAX_DATAGRAM = 2048;
+
+    explicit TradeFeed(size_t window);
+    ~TradeFeed();
+
+    TradeFeed(const TradeFeed&) = delete;
+    TradeFeed& operator=(const TradeFeed&) = delete;
+
+    //Binds to `address`:`port`. A multicast address is joined on the interface
+    //with address `interface` (empty for the default one).
+    bool open(const std::string& address, int port, const std::string& interface);
+
+    int socket_fd() const { return socket_; }
+
+    //Reads every waiting datagram and hands the trades that are now in sequence
+    //order to handle(frame, size), frame being the Header-framed Trade. Returns
+    //false if the socket failed.
+    template <typename Handler>
+    bool receive(Handler&& handle);
+
+    //Gives up waiting for the oldest missing trades and delivers the held ones after them
+    template <typename Handler>
+    void skip_gap(Handler&& handle);
+
+    bool has_gap() const { return tracker_.has_gap(); }
+    const SequenceTracker::Stats& stats() const { return tracker_.stats(); }
+    uint64_t datagrams() const { return datagrams_; }
+    uint64_t malformed() const { return malformed_; }
+    uint64_t syscalls() const { return syscalls_; }
+
+private:
+    int socket_ = -1;
+    SequenceTracker tracker_;
+    std::vector<char> buffers_;
+    std::vector<mmsghdr> headers_;
+    std::vector<iovec> vectors_;
+    uint64_t datagrams_ = 0;
+    uint64_t malformed_ = 0; //Datagrams with a truncated frame
+    uint64_t syscalls_ = 0;
+
+    //Reads up to BATCH datagrams. Returns their number, 0 when none are waiting, -1 on error.
+    int read_batch();
+};
+
+template <typename Handler>
+bool TradeFeed::receive(Handler&& handle) {
+    auto deliver = [&handle](uint32_t, const char* frame, size_t size) { handle(frame, size); };
+    while (true) {
+        int count = read_batch();
+        if (count <= 0) {
+            return count == 0;
+        }
+        for (int i = 0; i < count; ++i) {
+            const char* data = buffers_.data() + static_cast<size_t>(i) * MAX_DATAGRAM;
+            size_t size = headers_[i].msg_len;
+            ++datagrams_;
+            while (size > 0) {
+                Header header;
+                if (size < sizeof(Header)) {
+                    ++malformed_;
+                    break;
+                }
+                memcpy(&header, data, sizeof(Header));
+                size_t frame_size = sizeof(Header) + header.payload_size;
+                if (frame_size > size) {
+                    ++malformed_;
+                    break;
+                }
+                tracker_.on_message(header.sequence_number, data, frame_size, deliver);
+                data += frame_size;
+                size -= frame_size;
+            }
+        }
+        if (static_cast<size_t>(count) < BATCH) {
+            return true;
+        }
+    }
+}
+
+template <typename Handler>
+void TradeFeed::skip_gap(Handler&& handle) {
+    tracker_.skip_gap([&handle](uint32_t, const char* frame, size_t size) { handle(frame, size); });
+}
+
+#endif //TRADE_FEED_H_
@@ -11,6 +11,7 @@
 #define UTILS_H_
 
 #include <cstdint>
+#include <string>
 
 namespace utils {
 
@@ -23,6 +24,27 @@ uint64_t htonll(uint64_t value);
 //Converts a 64-bit integer from network to host byte order.
 uint64_t ntohll(uint64_t value);
 
+//Pins the calling thread to a single CPU core. Returns false if the core is unavailable.
+bool pin_current_thread(int core);
+
+//Runs the calling thread under SCHED_FIFO at `priority` (1-99). Returns false without
+//the privilege to do so (CAP_SYS_NICE or an RLIMIT_RTPRIO allowance).
+bool set_realtime_priority(int priority);
+
+//Pins the calling thread to `core` (-1 to leave it to the scheduler) and, with a
+//non-zero `fifo_priority`, makes it real-time, warning about whatever fails.
+//Then prints where the thread ended up, under `name`.
+void place_current_thread(const std::string& name, int core, int fifo_priority);
+
+//Tells the CPU the caller is spinning, easing pressure on a sibling hyperthread.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
 }  
 
 #endif //UTILS_H_
@@ -8,10 +8,13 @@
 #include "client.h"
 #include <iostream>
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <netinet/tcp.h>
 
 Client::Client(const std::string& server_ip, int server_port)
-    : server_ip_(server_ip), server_port_(server_port), server_socket_(-1) {
+    : server_socket_(-1), server_ip_(server_ip), server_port_(server_port) {
     memset(&server_addr_, 0, sizeof(server_addr_));
 }
 
@@ -70,3 +73,40 @@ bool Client::receive_response(char* buffer, size_t size) {
 
     return true;
 }
+
+bool Client::set_nonblocking() {
+    if (server_socket_ == -1) {
+        std::cerr << "No connection to server!\n";
+        return false;
+    }
+
+    int flags = fcntl(server_socket_, F_GETFL, 0);
+    if (flags == -1 || fcntl(server_socket_, F_SETFL, flags | O_NONBLOCK) == -1) {
+        std::cerr << "Failed to make the socket non-blocking!\n";
+        return false;
+    }
+
+    //Small messages are sent as soon as they are written
+    int one = 1;
+    setsockopt(server_socket_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+ssize_t Client::send_some(const char* data, size_t size) {
+    ssize_t bytes_sent = send(server_socket_, data, size, MSG_NOSIGNAL);
+    if (bytes_sent == -1) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+    return bytes_sent;
+}
+
+ssize_t Client::receive_some(char* buffer, size_t size) {
+    ssize_t bytes_received = recv(server_socket_, buffer, size, 0);
+    if (bytes_received == 0) {
+        return -1;
+    }
+    if (bytes_received == -1) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+    return bytes_received;
+}
@@ -0,0 +1,327 @@
+//config.cpp
+//
+//This file implements the command line parser for the RiskServer settings.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "config.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "order_pool.h"
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <max_buy_position> <max_sell_position> [options]\n"
+              << "Options:\n"
+              << "  --io-threads <n>        Number of event-loop threads (default 1)\n"
+              << "  --io-backend <backend>  epoll (default) or uring\n"
+              << "  --accept <mode>         shared (default): the first loop accepts for all, or reuseport:\n"
+              << "                          every loop listens on both ports and keeps what it accepts\n"
+              << "  --shards <n>            Number of instrument-partitioned State shards (default 1)\n"
+              << "  --shard-cores <list>    Comma-separated cores to pin the shard workers to\n"
+              << "  --io-cores <list>       Comma-separated cores to pin the event loops to, socket loops first\n"
+              << "  --sched-fifo <prio>     Run the event loops and shard workers SCHED_FIFO at <prio> (1-99)\n"
+              << "  --busy-poll <us>        Spin instead of sleeping when idle, with SO_BUSY_POLL of <us>\n"
+              << "                          microseconds on the sockets (default 0 = off)\n"
+              << "  --max-orders <n>        Resting orders preallocated per session and shard (default 65536)\n"
+              << "  --max-order-qty <n>     Reject orders larger than <n> (default 0 = no limit)\n"
+              << "  --max-notional <n>      Reject orders whose qty * price exceeds <n> (default 0 = no limit)\n"
+              << "  --price-collar <bps>    Reject orders priced further than <bps> basis points from the\n"
+              << "                          instrument's last trade (default 0 = no collar)\n"
+              << "  --max-account-position <n>\n"
+              << "                          Reject orders taking a session's summed worst positions over <n>\n"
+              << "  --max-account-notional <n>\n"
+              << "                          Reject orders taking a session's resting notional over <n>\n"
+              << "  --session-limits <path> Sessions clients may log on to, one per line:\n"
+              << "                          <session> <max_buy_position> <max_sell_position>\n"
+              << "  --log-level <level>     off, warn (rejections only) or info (default)\n"
+              << "  --order-port <port>     Port for order connections (default 55555)\n"
+              << "  --trade-port <port>     Port for trade connections (default 55556)\n"
+              << "  --journal <dir>         Journal accepted messages to <dir> and replay them on startup\n"
+              << "  --journal-sync <mode>   none (default), batch, or a sync interval in milliseconds\n"
+              << "  --snapshot-interval <s> Seconds between State snapshots (needs --journal; 0 = on SIGUSR2 only)\n"
+              << "  --on-disconnect <mode>  retain (default) or cancel a session's orders when its last\n"
+              << "                          order connection closes\n"
+              << "  --response-batch <n>    Responses batched per connection before an early send (default 64)\n"
+              << "  --trade-feed <addr:port>\n"
+              << "                          Also take trades from a UDP feed (multicast or unicast)\n"
+              << "  --trade-feed-interface <ip>\n"
+              << "                          Local interface address to join a multicast feed on\n"
+              << "  --trade-feed-window <n> Out-of-order trades held for a missing one (default 1024)\n"
+              << "  --trade-feed-gap-ms <ms>\n"
+              << "                          How long a missing trade is waited for (default 10)\n"
+              << "  --shm <names>           Comma-separated /dev/shm segments to serve co-located gateways on\n"
+              << "  --shm-wait <mode>       futex (default) to sleep while a gateway is idle, or spin\n"
+              << "  --positions <name>      Publish live instrument counters to /dev/shm/<name>\n"
+              << "  --positions-capacity <n>\n"
+              << "                          Instruments the position board has room for (default 65536)\n";
+}
+
+//Parses "<address>:<port>"
+bool parse_endpoint(const char* text, std::string& address, int& port) {
+    std::string endpoint(text);
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        return false;
+    }
+    address = endpoint.substr(0, colon);
+    char* end = nullptr;
+    long parsed = std::strtol(endpoint.c_str() + colon + 1, &end, 10);
+    port = static_cast<int>(parsed);
+    return *end == '\0' && parsed > 0 && parsed < 65536;
+}
+
+bool parse_int(const char* text, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parse_uint64(const char* text, uint64_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || *text == '-' || errno == ERANGE) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool parse_int64(const char* text, int64_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+//Reads "<session> <max_buy_position> <max_sell_position>" lines; '#' starts a comment
+bool read_session_limits(const char* path, std::vector<SessionLimits>& sessions) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Can't open " << path << "\n";
+        return false;
+    }
+    std::set<uint64_t> seen;
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        SessionLimits limits;
+        if (!(fields >> limits.session_id) && fields.eof()) {
+            continue;
+        }
+        std::string rest;
+        bool valid = !fields.fail() && fields >> limits.max_buy_position >> limits.max_sell_position &&
+                     !(fields >> rest) && limits.session_id != 0 && limits.max_buy_position >= 0 &&
+                     limits.max_sell_position >= 0 && seen.insert(limits.session_id).second;
+        if (!valid) {
+            std::cerr << path << ":" << number << ": expected <session> <max_buy_position> <max_sell_position> "
+                      << "for a new, non-zero session\n";
+            return false;
+        }
+        sessions.push_back(limits);
+    }
+    return true;
+}
+
+//Splits a comma-separated list such as "gw1,gw2"
+bool parse_name_list(const char* text, std::vector<std::string>& names) {
+    names.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end == start) {
+            return false;
+        }
+        names.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return !names.empty();
+}
+
+//Parses a comma-separated list such as "2,3,4"
+bool parse_int_list(const char* text, std::vector<int>& values) {
+    values.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        int value;
+        if (!parse_int(list.substr(start, end - start).c_str(), value)) {
+            return false;
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return !values.empty();
+}
+
+}
+
+bool parse_server_config(int argc, char* argv[], ServerConfig& config) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return false;
+    }
+
+    config.max_buy_position = std::atoi(argv[1]);
+    config.max_sell_position = std::atoi(argv[2]);
+
+    for (int i = 3; i < argc; ++i) {
+        const char* option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        const char* value = argv[++i];
+
+        bool ok = false;
+        if (std::strcmp(option, "--io-threads") == 0) {
+            ok = parse_int(value, config.io_threads) && config.io_threads > 0;
+        } else if (std::strcmp(option, "--io-backend") == 0) {
+            ok = true;
+            if (std::strcmp(value, "epoll") == 0) {
+                config.io_backend = IoBackend::EPOLL;
+            } else if (std::strcmp(value, "uring") == 0) {
+                config.io_backend = IoBackend::URING;
+            } else {
+                ok = false;
+            }
+        } else if (std::strcmp(option, "--accept") == 0) {
+            ok = true;
+            if (std::strcmp(value, "shared") == 0) {
+                config.accept_mode = AcceptMode::SHARED;
+            } else if (std::strcmp(value, "reuseport") == 0) {
+                config.accept_mode = AcceptMode::REUSEPORT;
+            } else {
+                ok = false;
+            }
+        } else if (std::strcmp(option, "--shards") == 0) {
+            ok = parse_int(value, config.shards) && config.shards > 0;
+        } else if (std::strcmp(option, "--shard-cores") == 0) {
+            ok = parse_int_list(value, config.shard_cores);
+        } else if (std::strcmp(option, "--io-cores") == 0) {
+            ok = parse_int_list(value, config.io_cores);
+        } else if (std::strcmp(option, "--sched-fifo") == 0) {
+            ok = parse_int(value, config.sched_fifo_priority) && config.sched_fifo_priority >= 0 &&
+                 config.sched_fifo_priority <= 99;
+        } else if (std::strcmp(option, "--busy-poll") == 0) {
+            ok = parse_int(value, config.busy_poll_us) && config.busy_poll_us >= 0;
+        } else if (std::strcmp(option, "--max-orders") == 0) {
+            //parse_int refuses anything above INT_MAX, so every slot of the pool has a 32-bit index
+            static_assert(INT_MAX <= OrderPool::MAX_CAPACITY, "--max-orders does not fit the order pool");
+            ok = parse_int(value, config.max_orders) && config.max_orders > 0;
+        } else if (std::strcmp(option, "--max-order-qty") == 0) {
+            ok = parse_uint64(value, config.max_order_qty);
+        } else if (std::strcmp(option, "--max-notional") == 0) {
+            ok = parse_uint64(value, config.max_notional);
+        } else if (std::strcmp(option, "--price-collar") == 0) {
+            ok = parse_uint64(value, config.price_collar_bps);
+        } else if (std::strcmp(option, "--max-account-position") == 0) {
+            ok = parse_int64(value, config.max_account_position) && config.max_account_position >= 0;
+        } else if (std::strcmp(option, "--max-account-notional") == 0) {
+            ok = parse_int64(value, config.max_account_notional) && config.max_account_notional >= 0;
+        } else if (std::strcmp(option, "--session-limits") == 0) {
+            ok = read_session_limits(value, config.sessions);
+        } else if (std::strcmp(option, "--log-level") == 0) {
+            ok = parse_log_level(value, config.log_level);
+        } else if (std::strcmp(option, "--order-port") == 0) {
+            ok = parse_int(value, config.order_port);
+        } else if (std::strcmp(option, "--trade-port") == 0) {
+            ok = parse_int(value, config.trade_port);
+        } else if (std::strcmp(option, "--journal") == 0) {
+            config.journal_dir = value;
+            ok = !config.journal_dir.empty();
+        } else if (std::strcmp(option, "--journal-sync") == 0) {
+            ok = parse_journal_sync(value, config.journal_sync, config.journal_sync_interval_ms);
+        } else if (std::strcmp(option, "--snapshot-interval") == 0) {
+            ok = parse_int(value, config.snapshot_interval_s) && config.snapshot_interval_s >= 0;
+        } else if (std::strcmp(option, "--response-batch") == 0) {
+            ok = parse_int(value, config.response_batch) && config.response_batch > 0;
+        } else if (std::strcmp(option, "--trade-feed") == 0) {
+            ok = parse_endpoint(value, config.trade_feed_address, config.trade_feed_port);
+        } else if (std::strcmp(option, "--trade-feed-interface") == 0) {
+            config.trade_feed_interface = value;
+            ok = true;
+        } else if (std::strcmp(option, "--trade-feed-window") == 0) {
+            ok = parse_int(value, config.trade_feed_window) && config.trade_feed_window > 0 &&
+                 config.trade_feed_window <= 1 << 20;
+        } else if (std::strcmp(option, "--trade-feed-gap-ms") == 0) {
+            ok = parse_int(value, config.trade_feed_gap_ms) && config.trade_feed_gap_ms > 0;
+        } else if (std::strcmp(option, "--shm") == 0) {
+            ok = parse_name_list(value, config.shm_gateways);
+        } else if (std::strcmp(option, "--shm-wait") == 0) {
+            ok = parse_shm_wait(value, config.shm_wait);
+        } else if (std::strcmp(option, "--positions") == 0) {
+            config.position_board = value;
+            ok = !config.position_board.empty();
+        } else if (std::strcmp(option, "--positions-capacity") == 0) {
+            ok = parse_int(value, config.position_board_capacity) && config.position_board_capacity > 0;
+        } else if (std::strcmp(option, "--on-disconnect") == 0) {
+            ok = true;
+            if (std::strcmp(value, "retain") == 0) {
+                config.on_disconnect = DisconnectPolicy::RETAIN;
+            } else if (std::strcmp(value, "cancel") == 0) {
+                config.on_disconnect = DisconnectPolicy::CANCEL;
+            } else {
+                ok = false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << option << "\n";
+            print_usage(argv[0]);
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid value for " << option << ": " << value << "\n";
+            return false;
+        }
+    }
+
+    if (config.snapshot_interval_s > 0 && config.journal_dir.empty()) {
+        std::cerr << "--snapshot-interval needs --journal\n";
+        return false;
+    }
+
+    //A spinning SCHED_FIFO thread never lets a lower or equal priority thread onto its core
+    if (config.busy_poll_us > 0 && config.sched_fifo_priority > 0) {
+        size_t loops = config.io_threads + config.shm_gateways.size();
+        std::set<int> cores(config.io_cores.begin(), config.io_cores.end());
+        cores.insert(config.shard_cores.begin(), config.shard_cores.end());
+        if (config.io_cores.size() < loops || config.shard_cores.size() < static_cast<size_t>(config.shards) ||
+            cores.size() != config.io_cores.size() + config.shard_cores.size()) {
+            std::cerr << "--busy-poll with --sched-fifo needs a core of its own for every event loop and shard "
+                         "(--io-cores, --shard-cores)\n";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+//example_shm_client.cpp
+//
+//This file implements an example gateway that talks to the RiskServer through a
+//shared-memory segment (started with --shm) and measures the round trip of each
+//message: a NewOrder and its DeleteOrder are sent one at a time, every send
+//waiting for the previous response.
+//
+//Usage: ExampleShmClient [segment] [round_trips] [spin|futex]
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "order.h"
+#include "shm_client.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+//Sends one framed message and returns the round trip in nanoseconds, or -1 on failure
+template <typename Message>
+int64_t round_trip(ShmClient& client, const Message& message, uint32_t sequence, bool& accepted) {
+    char buffer[sizeof(Header) + sizeof(Message)];
+    Header header = {1, sizeof(Message), sequence, 0};
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), &message, sizeof(message));
+
+    int64_t start = now_ns();
+    char response_buffer[sizeof(OrderResponse)];
+    if (!client.send_message(buffer, sizeof(buffer)) ||
+        !client.receive_response(response_buffer, sizeof(response_buffer))) {
+        return -1;
+    }
+    int64_t elapsed = now_ns() - start;
+
+    OrderResponse response;
+    memcpy(&response, response_buffer, sizeof(response));
+    accepted = response.stat == OrderResponse::Status::ACCEPTED;
+    return elapsed;
+}
+
+int64_t percentile(const std::vector<int64_t>& sorted, double fraction) {
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = argc > 1 ? argv[1] : "risk-gw0";
+    int round_trips = argc > 2 ? std::atoi(argv[2]) : 100000;
+    ShmWait wait = ShmWait::SPIN;
+    if (round_trips <= 0 || (argc > 3 && !parse_shm_wait(argv[3], wait))) {
+        std::cerr << "Usage: " << argv[0] << " [segment] [round_trips] [spin|futex]\n";
+        return -1;
+    }
+
+    ShmClient client(name, wait);
+    if (!client.connect_to_server()) {
+        std::cerr << "Failed to connect to server!\n";
+        return -1;
+    }
+
+    std::vector<int64_t> samples;
+    samples.reserve(static_cast<size_t>(round_trips) * 2);
+    int rejected = 0;
+    for (int i = 0; i < round_trips; ++i) {
+        uint64_t order_id = static_cast<uint64_t>(i) + 1;
+        bool accepted = false;
+        int64_t elapsed = round_trip(client, NewOrder{NewOrder::MESSAGE_TYPE, 1, order_id, 1, 100, 'B'},
+                                     static_cast<uint32_t>(2 * i), accepted);
+        if (elapsed < 0) {
+            return -1;
+        }
+        samples.push_back(elapsed);
+        rejected += !accepted;
+
+        elapsed = round_trip(client, DeleteOrder{DeleteOrder::MESSAGE_TYPE, order_id},
+                             static_cast<uint32_t>(2 * i + 1), accepted);
+        if (elapsed < 0) {
+            return -1;
+        }
+        samples.push_back(elapsed);
+        rejected += !accepted;
+    }
+    client.disconnect();
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << samples.size() << " round trips (" << rejected << " rejected), ns: p50 "
+              << percentile(samples, 0.5) << ", p99 " << percentile(samples, 0.99) << ", p99.9 "
+              << percentile(samples, 0.999) << ", max " << samples.back() << "\n";
+    return 0;
+}
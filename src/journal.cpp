@@ -0,0 +1,279 @@
+//journal.cpp
+//
+//This file implements the write-ahead journal and its memory-mapped reader.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "journal.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+//Initial capacity of the in-memory batch; grows if a batch needs more
+constexpr size_t BUFFER_CAPACITY = 1 << 20;
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}
+
+bool parse_journal_sync(const char* text, JournalSync& sync, int& interval_ms) {
+    if (std::strcmp(text, "none") == 0) {
+        sync = JournalSync::NONE;
+        return true;
+    }
+    if (std::strcmp(text, "batch") == 0) {
+        sync = JournalSync::BATCH;
+        return true;
+    }
+
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed <= 0) {
+        return false;
+    }
+    sync = JournalSync::PERIODIC;
+    interval_ms = static_cast<int>(parsed);
+    return true;
+}
+
+uint32_t journal_checksum(uint64_t session_id, uint16_t message_type, uint16_t payload_size, const char* payload) {
+    //FNV-1a: cheap, and any torn or zero-filled tail fails it
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 16777619u;
+    };
+    for (int shift = 0; shift < 64; shift += 8) {
+        mix(static_cast<uint8_t>(session_id >> shift));
+    }
+    mix(message_type & 0xFF);
+    mix(message_type >> 8);
+    mix(payload_size & 0xFF);
+    mix(payload_size >> 8);
+    for (uint16_t i = 0; i < payload_size; ++i) {
+        mix(static_cast<uint8_t>(payload[i]));
+    }
+    return hash;
+}
+
+JournalReader::~JournalReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+bool JournalReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        std::cerr << "Failed to open journal " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        std::cerr << "Failed to stat journal " << path << ": " << strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map journal " << path << ": " << strerror(errno) << "\n";
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const char*>(data);
+    madvise(data, size_, MADV_SEQUENTIAL);
+
+    //A header that was never completely written leaves an empty journal behind
+    if (size_ < sizeof(JournalFileHeader)) {
+        return true;
+    }
+    header_ = reinterpret_cast<const JournalFileHeader*>(data_);
+    if (header_->magic != JournalFileHeader::MAGIC || header_->version != JournalFileHeader::VERSION) {
+        std::cerr << "Journal " << path << " has an unknown format!\n";
+        return false;
+    }
+    offset_ = sizeof(JournalFileHeader);
+    return true;
+}
+
+bool JournalReader::next(const JournalRecordHeader*& record, const char*& payload) {
+    if (header_ == nullptr || offset_ + sizeof(JournalRecordHeader) > size_) {
+        return false;
+    }
+    record = reinterpret_cast<const JournalRecordHeader*>(data_ + offset_);
+    size_t record_end = offset_ + sizeof(JournalRecordHeader) + record->payload_size;
+    if (record_end > size_) {
+        return false;
+    }
+    payload = data_ + offset_ + sizeof(JournalRecordHeader);
+    if (journal_checksum(record->session_id, record->message_type, record->payload_size, payload) !=
+        record->checksum) {
+        return false;
+    }
+    offset_ = record_end;
+    return true;
+}
+
+bool JournalReader::skip_to(size_t offset) {
+    if (header_ == nullptr) {
+        return offset <= sizeof(JournalFileHeader);
+    }
+    if (offset < sizeof(JournalFileHeader) || offset > size_) {
+        return false;
+    }
+    offset_ = offset;
+    return true;
+}
+
+Journal::~Journal() {
+    if (fd_ != -1) {
+        commit();
+        sync();
+        close(fd_);
+    }
+}
+
+bool Journal::open(const std::string& path, size_t valid_size, uint16_t shard, uint16_t shard_count,
+                   JournalSync sync, int sync_interval_ms) {
+    path_ = path;
+    sync_ = sync;
+    sync_interval_ns_ = static_cast<int64_t>(sync_interval_ms) * 1'000'000;
+    buffer_.reserve(BUFFER_CAPACITY);
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open journal " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    //Drop a torn tail, or a header that never made it to disk
+    if (valid_size < sizeof(JournalFileHeader)) {
+        valid_size = 0;
+    }
+    if (ftruncate(fd_, valid_size) < 0 || lseek(fd_, valid_size, SEEK_SET) < 0) {
+        std::cerr << "Failed to truncate journal " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    file_size_ = valid_size;
+
+    if (valid_size == 0) {
+        JournalFileHeader header{JournalFileHeader::MAGIC, JournalFileHeader::VERSION, shard, shard_count, {}};
+        const char* bytes = reinterpret_cast<const char*>(&header);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(header));
+        if (!commit() || !sync_now()) {
+            return false;
+        }
+    }
+    last_sync_ns_ = steady_ns();
+    return true;
+}
+
+void Journal::append(uint64_t session_id, uint16_t message_type, const void* payload, uint16_t payload_size) {
+    const char* payload_bytes = static_cast<const char*>(payload);
+    JournalRecordHeader record{message_type, payload_size,
+                               journal_checksum(session_id, message_type, payload_size, payload_bytes), session_id};
+    const char* record_bytes = reinterpret_cast<const char*>(&record);
+    buffer_.insert(buffer_.end(), record_bytes, record_bytes + sizeof(record));
+    buffer_.insert(buffer_.end(), payload_bytes, payload_bytes + payload_size);
+}
+
+bool Journal::commit() {
+    if (failed_) {
+        buffer_.clear();
+        return false;
+    }
+    if (buffer_.empty()) {
+        return true;
+    }
+
+    size_t written = 0;
+    while (written < buffer_.size()) {
+        ssize_t result = write(fd_, buffer_.data() + written, buffer_.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Failed to write journal " << path_ << ": " << strerror(errno) << "\n";
+            fail();
+            return false;
+        }
+        written += result;
+    }
+    uint64_t batch_start = file_size_;
+    file_size_ += buffer_.size();
+    buffer_.clear();
+    dirty_ = true;
+
+    bool synced = true;
+    switch (sync_) {
+        case JournalSync::NONE:
+            break;
+        case JournalSync::BATCH:
+            synced = sync_now();
+            break;
+        case JournalSync::PERIODIC:
+            synced = steady_ns() - last_sync_ns_ < sync_interval_ns_ || sync_now();
+            break;
+    }
+    if (!synced) {
+        //The batch will not be acknowledged, so it must not come back on replay either
+        file_size_ = batch_start;
+        fail();
+    }
+    return synced;
+}
+
+bool Journal::sync() {
+    if (!dirty_ || sync_ == JournalSync::NONE) {
+        return true;
+    }
+    return sync_now();
+}
+
+bool Journal::sync_now() {
+    if (fdatasync(fd_) < 0) {
+        //The kernel may have dropped the dirty pages, so what the file holds is unknown
+        std::cerr << "Failed to sync journal " << path_ << ": " << strerror(errno) << "\n";
+        failed_ = true;
+        return false;
+    }
+    dirty_ = false;
+    last_sync_ns_ = steady_ns();
+    return true;
+}
+
+void Journal::fail() {
+    failed_ = true;
+    buffer_.clear();
+
+    //Cut a partly written batch off so that the file still ends at a record boundary
+    if (ftruncate(fd_, file_size_) < 0 || lseek(fd_, file_size_, SEEK_SET) < 0) {
+        std::cerr << "Failed to truncate journal " << path_ << " after a failed write: " << strerror(errno)
+                  << "; its tail may be torn\n";
+    }
+}
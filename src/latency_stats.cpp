@@ -0,0 +1,134 @@
+//latency_stats.cpp
+//
+//This file implements the TSC clock calibration, the LatencyHistogram bucket
+//arithmetic and the LatencyStats report.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "latency_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+double TscClock::ns_per_tick_ = 1.0;
+
+uint64_t TscClock::steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void TscClock::calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t start_ns = steady_ns();
+    uint64_t start_ticks = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t elapsed_ns = steady_ns() - start_ns;
+    uint64_t elapsed_ticks = now() - start_ticks;
+    if (elapsed_ticks > 0) {
+        ns_per_tick_ = static_cast<double>(elapsed_ns) / static_cast<double>(elapsed_ticks);
+    }
+#endif
+}
+
+int LatencyHistogram::bucket_for(uint64_t value) {
+    //Values below SUB_BUCKETS are exact; above that, keep the top SUB_BUCKET_BITS + 1 bits
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    int sub_bucket = static_cast<int>(value >> shift) - SUB_BUCKETS;
+    return (shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub_bucket = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::merge_into(std::vector<uint64_t>& counts, uint64_t& max) const {
+    counts.resize(BUCKETS);
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] += counts_[i].load(std::memory_order_relaxed);
+    }
+    max = std::max(max, max_.load(std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::percentile(const std::vector<uint64_t>& counts, double percent) {
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    //Smallest bucket whose cumulative count reaches the requested rank
+    uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucket_upper_bound(static_cast<int>(i));
+        }
+    }
+    return bucket_upper_bound(BUCKETS - 1);
+}
+
+LatencyStats& LatencyStats::instance() {
+    static LatencyStats stats;
+    return stats;
+}
+
+LatencyStats::ThreadHistograms& LatencyStats::thread_histograms() {
+    thread_local ThreadHistograms* histograms = nullptr;
+    if (histograms == nullptr) {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        threads_.push_back(std::make_unique<ThreadHistograms>());
+        histograms = threads_.back().get();
+    }
+    return *histograms;
+}
+
+void LatencyStats::report(std::ostream& out) {
+    static const char* TYPE_NAMES[MESSAGE_TYPES] = {"NewOrder", "DeleteOrder", "ModifyOrderQty", "Trade"};
+    static const char* STAGE_NAMES[STAGES] = {"parse", "queue", "check", "respond", "total"};
+
+    out << std::left << std::setw(16) << "Message" << std::setw(9) << "Stage" << std::right
+        << std::setw(12) << "Count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9" << std::setw(12) << "max (ns)" << "\n";
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (int type = 0; type < MESSAGE_TYPES; ++type) {
+        for (int stage = 0; stage < STAGES; ++stage) {
+            std::vector<uint64_t> counts(LatencyHistogram::BUCKETS, 0);
+            uint64_t max = 0;
+            for (auto& thread : threads_) {
+                thread->histograms[type][stage].merge_into(counts, max);
+            }
+
+            uint64_t total = 0;
+            for (uint64_t count : counts) {
+                total += count;
+            }
+            if (total == 0) {
+                continue;
+            }
+
+            out << std::left << std::setw(16) << TYPE_NAMES[type] << std::setw(9) << STAGE_NAMES[stage]
+                << std::right << std::setw(12) << total
+                << std::setw(10) << LatencyHistogram::percentile(counts, 50.0)
+                << std::setw(10) << LatencyHistogram::percentile(counts, 99.0)
+                << std::setw(10) << LatencyHistogram::percentile(counts, 99.9)
+                << std::setw(12) << max << "\n";
+        }
+    }
+}
@@ -0,0 +1,545 @@
+//load_gen.cpp
+//
+//This file implements RiskLoadGen, an open-loop load generator for the RiskServer.
+//
+//It opens a number of order and trade connections and sends a mix of NewOrder,
+//ModifyOrderQty, DeleteOrder and Trade messages at a fixed target rate. The rate is
+//open-loop: every message has an intended send time on a fixed schedule, and a
+//slow response never delays the next message. Latency is measured from the
+//intended send time rather than the moment the message was actually written, so
+//stalls in the server (or in the generator) show up in the percentiles instead of
+//silently lowering the offered load (coordinated omission). The uncorrected
+//figures are printed alongside for comparison.
+//
+//Every connection keeps its own set of resting orders, so modifies and deletes
+//always target orders it created. Responses are matched to requests by order_id.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "client.h"
+#include "latency_stats.h"
+#include "order.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+//Index of each message type in the mix
+enum MessageKind { NEW, MODIFY, DELETE, TRADE, KINDS };
+
+const char* KIND_NAMES[KINDS] = {"NewOrder", "ModifyOrderQty", "DeleteOrder", "Trade"};
+
+//How long to wait for outstanding responses once sending has stopped
+constexpr int64_t DRAIN_TIMEOUT_NS = 2'000'000'000;
+
+struct LoadGenConfig {
+    std::string host = "127.0.0.1";
+    int order_port = 55555;
+    int trade_port = 55556;
+    int connections = 4;
+    int trade_connections = 1;
+    int threads = 1;
+    double rate = 10'000;  //Messages per second across all connections
+    double duration = 10;  //Seconds of sending
+    int instruments = 100;
+    int max_live = 1000;   //Resting orders per connection before NewOrders turn into deletes
+    int mix[KINDS] = {50, 20, 25, 5};
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+//A request waiting for its response
+struct Pending {
+    int64_t intended_ns;
+    int64_t sent_ns;
+    MessageKind kind;
+};
+
+struct Connection {
+    std::unique_ptr<Client> client;
+    std::string output;
+    size_t output_offset = 0;
+    std::vector<char> input;
+    uint32_t sequence = 0;
+    std::vector<uint64_t> live; //Resting orders this connection may modify or delete
+    std::unordered_map<uint64_t, std::deque<Pending>> pending;
+};
+
+struct WorkerStats {
+    uint64_t sent[KINDS] = {};
+    uint64_t responses = 0;
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    uint64_t outstanding = 0;
+    uint64_t late = 0; //Messages generated more than 1ms behind schedule
+    LatencyHistogram corrected;
+    LatencyHistogram uncorrected;
+};
+
+class Worker {
+public:
+    Worker(const LoadGenConfig& config, size_t index, double rate)
+        : config_(config), rng_(index + 1), interval_ns_(std::max<int64_t>(1, static_cast<int64_t>(1e9 / rate))), stats_(std::make_unique<WorkerStats>()) {
+        //Order IDs are unique per run, worker and connection
+        uint64_t run = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) & 0xFFFFFF;
+        next_order_id_ = (run << 40) | (static_cast<uint64_t>(index) << 32);
+
+        mix_total_ = 0;
+        for (int kind = 0; kind < KINDS; ++kind) {
+            mix_total_ += config.mix[kind];
+        }
+    }
+
+    bool add_connection(bool is_trade) {
+        auto connection = std::make_unique<Connection>();
+        connection->client = std::make_unique<Client>(config_.host, is_trade ? config_.trade_port : config_.order_port);
+        if (!connection->client->connect_to_server() || !connection->client->set_nonblocking()) {
+            return false;
+        }
+        (is_trade ? trade_connections_ : order_connections_).push_back(std::move(connection));
+        return true;
+    }
+
+    void run(int64_t start_ns) {
+        int64_t next_ns = start_ns;
+        int64_t stop_ns = start_ns + static_cast<int64_t>(config_.duration * 1e9);
+        bool sending = !order_connections_.empty();
+
+        while (true) {
+            int64_t now = now_ns();
+            if (sending && now >= stop_ns) {
+                sending = false;
+            }
+            while (sending && next_ns <= now && next_ns < stop_ns) {
+                generate(next_ns, now);
+                next_ns += interval_ns_;
+            }
+
+            bool ok = flush_all() && receive_all();
+            if (!ok) {
+                break;
+            }
+            if (!sending && (stats_->outstanding == 0 || now >= stop_ns + DRAIN_TIMEOUT_NS)) {
+                break;
+            }
+            wait(sending ? next_ns - now_ns() : 1'000'000);
+        }
+    }
+
+    const WorkerStats& stats() const { return *stats_; }
+
+private:
+    const LoadGenConfig& config_;
+    std::mt19937_64 rng_;
+    int64_t interval_ns_;
+    std::unique_ptr<WorkerStats> stats_;
+    std::vector<std::unique_ptr<Connection>> order_connections_;
+    std::vector<std::unique_ptr<Connection>> trade_connections_;
+    std::vector<pollfd> poll_fds_;
+    size_t next_order_connection_ = 0;
+    size_t next_trade_connection_ = 0;
+    uint64_t next_order_id_;
+    uint64_t next_trade_id_ = 1;
+    int mix_total_;
+
+    MessageKind pick_kind(const Connection& connection) {
+        int roll = static_cast<int>(rng_() % mix_total_);
+        int kind = 0;
+        while (roll >= config_.mix[kind]) {
+            roll -= config_.mix[kind];
+            ++kind;
+        }
+
+        //Keep every choice valid for the connection's current book
+        if (kind == TRADE && trade_connections_.empty()) {
+            kind = NEW;
+        }
+        if (kind == NEW && connection.live.size() >= static_cast<size_t>(config_.max_live)) {
+            kind = DELETE;
+        }
+        if ((kind == MODIFY || kind == DELETE) && connection.live.empty()) {
+            kind = NEW;
+        }
+        return static_cast<MessageKind>(kind);
+    }
+
+    template <typename Message>
+    void append(Connection& connection, const Message& message) {
+        Header header = {1, sizeof(message), ++connection.sequence, 0};
+        connection.output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        connection.output.append(reinterpret_cast<const char*>(&message), sizeof(message));
+    }
+
+    void generate(int64_t intended_ns, int64_t now) {
+        Connection& connection = *order_connections_[next_order_connection_++ % order_connections_.size()];
+        MessageKind kind = pick_kind(connection);
+        if (now - intended_ns > 1'000'000) {
+            ++stats_->late;
+        }
+        ++stats_->sent[kind];
+
+        uint64_t instrument_id = rng_() % config_.instruments + 1;
+        if (kind == TRADE) {
+            Connection& trade_connection = *trade_connections_[next_trade_connection_++ % trade_connections_.size()];
+            int64_t qty = static_cast<int64_t>(rng_() % 10) + 1;
+            append(trade_connection, Trade{Trade::MESSAGE_TYPE, instrument_id, next_trade_id_++,
+                                           rng_() % 2 == 0 ? qty : -qty, 100});
+            return;
+        }
+
+        uint64_t order_id;
+        if (kind == NEW) {
+            order_id = ++next_order_id_;
+            connection.live.push_back(order_id);
+            append(connection, NewOrder{NewOrder::MESSAGE_TYPE, instrument_id, order_id, rng_() % 10 + 1,
+                                        100 + rng_() % 10, rng_() % 2 == 0 ? 'B' : 'S'});
+        } else {
+            size_t index = rng_() % connection.live.size();
+            order_id = connection.live[index];
+            if (kind == MODIFY) {
+                append(connection, ModifyOrderQty{ModifyOrderQty::MESSAGE_TYPE, order_id, rng_() % 10 + 1});
+            } else {
+                connection.live[index] = connection.live.back();
+                connection.live.pop_back();
+                append(connection, DeleteOrder{DeleteOrder::MESSAGE_TYPE, order_id});
+            }
+        }
+        connection.pending[order_id].push_back({intended_ns, now, kind});
+        ++stats_->outstanding;
+    }
+
+    bool flush(Connection& connection) {
+        while (connection.output_offset < connection.output.size()) {
+            ssize_t sent = connection.client->send_some(connection.output.data() + connection.output_offset,
+                                                        connection.output.size() - connection.output_offset);
+            if (sent < 0) {
+                std::cerr << "Connection lost while sending!\n";
+                return false;
+            }
+            if (sent == 0) {
+                return true;
+            }
+            connection.output_offset += sent;
+        }
+        connection.output.clear();
+        connection.output_offset = 0;
+        return true;
+    }
+
+    bool flush_all() {
+        for (auto& connection : order_connections_) {
+            if (!flush(*connection)) {
+                return false;
+            }
+        }
+        for (auto& connection : trade_connections_) {
+            if (!flush(*connection)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool receive(Connection& connection) {
+        char buffer[64 * 1024];
+        while (true) {
+            ssize_t received = connection.client->receive_some(buffer, sizeof(buffer));
+            if (received < 0) {
+                std::cerr << "Connection lost while receiving!\n";
+                return false;
+            }
+            if (received == 0) {
+                return true;
+            }
+            connection.input.insert(connection.input.end(), buffer, buffer + received);
+
+            int64_t now = now_ns();
+            size_t offset = 0;
+            for (; offset + sizeof(OrderResponse) <= connection.input.size(); offset += sizeof(OrderResponse)) {
+                OrderResponse response;
+                memcpy(&response, connection.input.data() + offset, sizeof(response));
+                on_response(connection, response, now);
+            }
+            connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+        }
+    }
+
+    bool receive_all() {
+        for (auto& connection : order_connections_) {
+            if (!receive(*connection)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void on_response(Connection& connection, const OrderResponse& response, int64_t now) {
+        auto it = connection.pending.find(response.order_id);
+        if (it == connection.pending.end()) {
+            return;
+        }
+        Pending pending = it->second.front();
+        it->second.pop_front();
+        if (it->second.empty()) {
+            connection.pending.erase(it);
+        }
+
+        WorkerStats& stats = *stats_;
+        --stats.outstanding;
+        ++stats.responses;
+        if (response.stat == OrderResponse::Status::ACCEPTED) {
+            ++stats.accepted;
+        } else {
+            ++stats.rejected;
+            //A rejected NewOrder never rested, so stop referring to it
+            if (pending.kind == NEW) {
+                auto live = std::find(connection.live.begin(), connection.live.end(), response.order_id);
+                if (live != connection.live.end()) {
+                    *live = connection.live.back();
+                    connection.live.pop_back();
+                }
+            }
+        }
+        stats.corrected.record(now - pending.intended_ns);
+        stats.uncorrected.record(now - pending.sent_ns);
+    }
+
+    //Sleeps until a socket is ready or the next message is due
+    void wait(int64_t timeout_ns) {
+        if (timeout_ns <= 0) {
+            return;
+        }
+        poll_fds_.clear();
+        for (auto& connection : order_connections_) {
+            short events = POLLIN;
+            if (!connection->output.empty()) {
+                events |= POLLOUT;
+            }
+            poll_fds_.push_back({connection->client->socket_fd(), events, 0});
+        }
+        for (auto& connection : trade_connections_) {
+            if (!connection->output.empty()) {
+                poll_fds_.push_back({connection->client->socket_fd(), POLLOUT, 0});
+            }
+        }
+        timespec timeout = {timeout_ns / 1'000'000'000, timeout_ns % 1'000'000'000};
+        ppoll(poll_fds_.data(), poll_fds_.size(), &timeout, nullptr);
+    }
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Options:\n"
+              << "  --host <ip>                Server address (default 127.0.0.1)\n"
+              << "  --order-port <port>        Port for order connections (default 55555)\n"
+              << "  --trade-port <port>        Port for trade connections (default 55556)\n"
+              << "  --connections <n>          Order connections (default 4)\n"
+              << "  --trade-connections <n>    Trade connections (default 1)\n"
+              << "  --threads <n>              Sending threads; connections are shared out (default 1)\n"
+              << "  --rate <msgs/s>            Target rate across all connections (default 10000)\n"
+              << "  --duration <seconds>       How long to send for (default 10)\n"
+              << "  --instruments <n>          Instrument IDs to spread orders over (default 100)\n"
+              << "  --max-live <n>             Resting orders per connection (default 1000)\n"
+              << "  --mix <new,mod,del,trade>  Message mix weights (default 50,20,25,5)\n";
+}
+
+bool parse_number(const char* text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && value > 0;
+}
+
+bool parse_count(const char* text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parse_mix(const char* text, int (&mix)[KINDS]) {
+    std::string list(text);
+    size_t start = 0;
+    int total = 0;
+    for (int kind = 0; kind < KINDS; ++kind) {
+        size_t end = list.find(',', start);
+        if ((end == std::string::npos) != (kind == KINDS - 1)) {
+            return false;
+        }
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        char* parse_end = nullptr;
+        std::string item = list.substr(start, end - start);
+        long weight = std::strtol(item.c_str(), &parse_end, 10);
+        if (item.empty() || *parse_end != '\0' || weight < 0) {
+            return false;
+        }
+        mix[kind] = static_cast<int>(weight);
+        total += mix[kind];
+        start = end + 1;
+    }
+    return mix[NEW] > 0 && total > 0;
+}
+
+bool parse_load_gen_config(int argc, char* argv[], LoadGenConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const char* option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+
+        bool ok = false;
+        if (std::strcmp(option, "--host") == 0) {
+            config.host = value;
+            ok = true;
+        } else if (std::strcmp(option, "--order-port") == 0) {
+            ok = parse_count(value, config.order_port);
+        } else if (std::strcmp(option, "--trade-port") == 0) {
+            ok = parse_count(value, config.trade_port);
+        } else if (std::strcmp(option, "--connections") == 0) {
+            ok = parse_count(value, config.connections);
+        } else if (std::strcmp(option, "--trade-connections") == 0) {
+            ok = parse_count(value, config.trade_connections);
+        } else if (std::strcmp(option, "--threads") == 0) {
+            ok = parse_count(value, config.threads);
+        } else if (std::strcmp(option, "--rate") == 0) {
+            ok = parse_number(value, config.rate);
+        } else if (std::strcmp(option, "--duration") == 0) {
+            ok = parse_number(value, config.duration);
+        } else if (std::strcmp(option, "--instruments") == 0) {
+            ok = parse_count(value, config.instruments);
+        } else if (std::strcmp(option, "--max-live") == 0) {
+            ok = parse_count(value, config.max_live);
+        } else if (std::strcmp(option, "--mix") == 0) {
+            ok = parse_mix(value, config.mix);
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid value for " << option << ": " << value << "\n";
+            return false;
+        }
+    }
+
+    if (config.threads < 1 || config.connections < config.threads) {
+        std::cerr << "Need at least one order connection per thread\n";
+        return false;
+    }
+    if (config.instruments < 1 || config.max_live < 1) {
+        std::cerr << "--instruments and --max-live must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+void print_latency(const char* label, const std::vector<std::unique_ptr<Worker>>& workers, bool corrected) {
+    std::vector<uint64_t> counts(LatencyHistogram::BUCKETS);
+    uint64_t max = 0;
+    for (auto& worker : workers) {
+        const WorkerStats& stats = worker->stats();
+        (corrected ? stats.corrected : stats.uncorrected).merge_into(counts, max);
+    }
+
+    std::cout << std::left << std::setw(14) << label << std::right;
+    for (double percent : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+        std::cout << std::setw(10) << LatencyHistogram::percentile(counts, percent) / 1000.0;
+    }
+    std::cout << std::setw(10) << max / 1000.0 << "\n";
+}
+
+void print_report(const LoadGenConfig& config, const std::vector<std::unique_ptr<Worker>>& workers, double elapsed) {
+    uint64_t sent[KINDS] = {};
+    uint64_t total_sent = 0, responses = 0, accepted = 0, rejected = 0, outstanding = 0, late = 0;
+    for (auto& worker : workers) {
+        const WorkerStats& stats = worker->stats();
+        for (int kind = 0; kind < KINDS; ++kind) {
+            sent[kind] += stats.sent[kind];
+            total_sent += stats.sent[kind];
+        }
+        responses += stats.responses;
+        accepted += stats.accepted;
+        rejected += stats.rejected;
+        outstanding += stats.outstanding;
+        late += stats.late;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Target rate:     " << config.rate << " msgs/s for " << config.duration << " s\n";
+    std::cout << "Sent:            " << total_sent << " (" << total_sent / config.duration << " msgs/s)\n";
+    for (int kind = 0; kind < KINDS; ++kind) {
+        std::cout << "  " << std::left << std::setw(15) << KIND_NAMES[kind] << std::right << sent[kind] << "\n";
+    }
+    std::cout << "Responses:       " << responses << " (" << responses / elapsed << " /s), " << accepted
+              << " accepted, " << rejected << " rejected, " << outstanding << " unanswered\n";
+    std::cout << "Sent late:       " << late << " (more than 1 ms behind schedule)\n\n";
+
+    std::cout << "Round-trip latency (us)\n";
+    std::cout << std::left << std::setw(14) << "" << std::right << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "p99.99" << std::setw(10)
+              << "max" << "\n";
+    print_latency("corrected", workers, true);
+    print_latency("uncorrected", workers, false);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    LoadGenConfig config;
+    if (!parse_load_gen_config(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < config.threads; ++i) {
+        workers.push_back(std::make_unique<Worker>(config, i, config.rate / config.threads));
+    }
+    for (int i = 0; i < config.connections; ++i) {
+        if (!workers[i % config.threads]->add_connection(false)) {
+            return 1;
+        }
+    }
+    for (int i = 0; i < config.trade_connections; ++i) {
+        if (!workers[i % config.threads]->add_connection(true)) {
+            return 1;
+        }
+    }
+
+    int64_t start_ns = now_ns();
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back(&Worker::run, worker.get(), start_ns);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = (now_ns() - start_ns) / 1e9;
+
+    print_report(config, workers, elapsed);
+    return 0;
+}
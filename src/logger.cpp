@@ -0,0 +1,150 @@
+//logger.cpp
+//
+//This file implements the Logger class, which formats binary LogEvents on a
+//background thread.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "order.h"
+#include "utils.h"
+
+bool parse_log_level(const char* text, LogLevel& level) {
+    if (std::strcmp(text, "off") == 0) {
+        level = LogLevel::OFF;
+    } else if (std::strcmp(text, "warn") == 0) {
+        level = LogLevel::WARN;
+    } else if (std::strcmp(text, "info") == 0) {
+        level = LogLevel::INFO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::start(LogLevel level) {
+    stop();
+    level_.store(static_cast<uint8_t>(level));
+    if (level == LogLevel::OFF) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&Logger::run, this);
+}
+
+void Logger::stop() {
+    level_.store(static_cast<uint8_t>(LogLevel::OFF));
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Logger::log(LogEvent event) {
+    event.timestamp = utils::get_current_timestamp();
+    if (!ring_for_this_thread().try_push(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SpscQueue<LogEvent>& Logger::ring_for_this_thread() {
+    thread_local SpscQueue<LogEvent>* ring = nullptr;
+    if (ring == nullptr) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(std::make_unique<SpscQueue<LogEvent>>(RING_CAPACITY));
+        ring = rings_.back().get();
+    }
+    return *ring;
+}
+
+void Logger::run() {
+    std::string output;
+    while (running_.load()) {
+        if (drain(output) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    //Producers may still be finishing their last event
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    drain(output);
+}
+
+size_t Logger::drain(std::string& output) {
+    size_t formatted = 0;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        LogEvent event;
+        for (auto& ring : rings_) {
+            while (ring->try_pop(event)) {
+                format(event, output);
+                ++formatted;
+            }
+        }
+    }
+
+    if (!output.empty()) {
+        fwrite(output.data(), 1, output.size(), stdout);
+        fflush(stdout);
+        output.clear();
+    }
+    return formatted;
+}
+
+void Logger::format(const LogEvent& event, std::string& output) {
+    const char* status = event.accepted ? "Accepted" : "Rejected";
+
+    output += '[';
+    output += std::to_string(event.timestamp);
+    output += "] ";
+    switch (event.message_type) {
+        case NewOrder::MESSAGE_TYPE:
+            output += "Processed New Order: Order ID " + std::to_string(event.order_id) +
+                      ", Instrument " + std::to_string(event.instrument_id) +
+                      ", Quantity " + std::to_string(event.quantity) +
+                      ", Price " + std::to_string(event.price) +
+                      ", Side " + (event.side == 'B' ? "Buy" : "Sell") +
+                      ", Status " + status + "\n";
+            break;
+        case DeleteOrder::MESSAGE_TYPE:
+            output += "Processed Delete Order: Order ID " + std::to_string(event.order_id) +
+                      ", Status " + (event.accepted ? "Deleted" : "Not Found") + "\n";
+            break;
+        case ModifyOrderQty::MESSAGE_TYPE:
+            output += "Processed Modify Order Quantity: Order ID " + std::to_string(event.order_id) +
+                      ", New Quantity " + std::to_string(event.quantity) +
+                      ", Status " + status + "\n";
+            break;
+        case Trade::MESSAGE_TYPE:
+            output += "Processed Trade: Instrument " + std::to_string(event.instrument_id) +
+                      ", Quantity " + std::to_string(event.quantity) +
+                      ", Price " + std::to_string(event.price) + "\n";
+            break;
+        default:
+            output += "Unknown event type " + std::to_string(event.message_type) + "\n";
+            return;
+    }
+
+    if (event.has_position) {
+        const State::Position& position = event.position;
+        int64_t buy_side = std::max(position.buy_qty, position.net_position + position.buy_qty);
+        int64_t sell_side = std::max(position.sell_qty, position.sell_qty - position.net_position);
+        output += "Instrument ID: " + std::to_string(event.instrument_id) + "\n" +
+                  "Net Position: " + std::to_string(position.net_position) + "\n" +
+                  "Buy Qty: " + std::to_string(position.buy_qty) + "\n" +
+                  "Sell Qty: " + std::to_string(position.sell_qty) + "\n" +
+                  "Hypothetical Worst Buy Position: " + std::to_string(buy_side) + "\n" +
+                  "Hypothetical Worst Sell Position: " + std::to_string(sell_side) + "\n\n";
+    }
+}
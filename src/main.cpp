@@ -5,20 +5,18 @@
 //Author: Nikas Zilinskis
 //Date: 18/06/2024
 
+#include "config.h"
 #include "server.h"
 #include <iostream>
 #include <cstdlib>
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <max_buy_position> <max_sell_position>\n";
+    ServerConfig config;
+    if (!parse_server_config(argc, argv, config)) {
         return -1;
     }
 
-    int max_buy_position = std::atoi(argv[1]);
-    int max_sell_position = std::atoi(argv[2]);
-
-    RiskServer server(max_buy_position, max_sell_position);
+    RiskServer server(config);
 
     if (!server.init()) {
         std::cerr << "Failed to initialize the server!\n";
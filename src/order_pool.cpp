@@ -0,0 +1,60 @@
+//order_pool.cpp
+//
+//This file implements the OrderPool class, the preallocated slab of resting
+//order records.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "order_pool.h"
+
+#include <algorithm> //For std::min
+
+OrderPool::OrderPool(size_t capacity) : nodes_(std::min(capacity, MAX_CAPACITY)) {
+    reset();
+}
+
+uint32_t OrderPool::allocate() {
+    uint32_t index = free_head_;
+    if (index != NONE) {
+        free_head_ = nodes_[index].next;
+        ++in_use_;
+    }
+    return index;
+}
+
+void OrderPool::release(uint32_t index) {
+    nodes_[index].next = free_head_;
+    free_head_ = index;
+    --in_use_;
+}
+
+void OrderPool::link_front(uint32_t& head, uint32_t index) {
+    Node& node = nodes_[index];
+    node.prev = NONE;
+    node.next = head;
+    if (head != NONE) {
+        nodes_[head].prev = index;
+    }
+    head = index;
+}
+
+void OrderPool::unlink(uint32_t& head, uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != NONE) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        head = node.next;
+    }
+    if (node.next != NONE) {
+        nodes_[node.next].prev = node.prev;
+    }
+}
+
+void OrderPool::reset() {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        nodes_[i].next = (i + 1 < nodes_.size()) ? static_cast<uint32_t>(i + 1) : NONE;
+    }
+    free_head_ = nodes_.empty() ? NONE : 0;
+    in_use_ = 0;
+}
@@ -0,0 +1,179 @@
+//position_board.cpp
+//
+//This file implements the shared-memory position board: creating it in the
+//server and mapping it read-only in the readers.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "position_board.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+namespace {
+
+//A shard holds a slot odd for a handful of stores; a slot odd for longer was left by a server that died mid-write
+constexpr int MAX_READ_SPINS = 1 << 16;
+
+std::string shm_path(const std::string& name) {
+    return name.front() == '/' ? name : "/" + name;
+}
+
+size_t board_size(size_t capacity) {
+    return sizeof(PositionBoardHeader) + capacity * sizeof(PositionSlot);
+}
+
+const PositionSlot* slots_of(const PositionBoardHeader* header) {
+    return reinterpret_cast<const PositionSlot*>(header + 1);
+}
+
+}
+
+PositionBoard::~PositionBoard() {
+    if (header_ != nullptr) {
+        munmap(header_, size_);
+        shm_unlink(shm_path(name_).c_str());
+    }
+}
+
+bool PositionBoard::create(const std::string& name, size_t capacity) {
+    if (name.empty() || capacity == 0) {
+        return false;
+    }
+    name_ = name;
+    std::string path = shm_path(name);
+
+    //Readers still mapping a board left by a server that died keep their old copy
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Can't create position board " << path << "\n";
+        return false;
+    }
+    size_t size = board_size(capacity);
+    if (ftruncate(fd, size) < 0) {
+        std::cerr << "Can't size position board " << path << "\n";
+        close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    //The fresh mapping is zero-filled, so every slot starts unpublished
+    header_ = new (memory) PositionBoardHeader{};
+    size_ = size;
+    header_->magic = PositionBoardHeader::MAGIC;
+    header_->version = PositionBoardHeader::VERSION;
+    header_->capacity = capacity;
+    return true;
+}
+
+PositionSlot* PositionBoard::claim(uint32_t shard, uint64_t session_id, uint64_t instrument_id) {
+    uint64_t index = header_->slot_count.load(std::memory_order_relaxed);
+    do {
+        if (index >= header_->capacity) {
+            header_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    } while (!header_->slot_count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+    //Readers skip the slot until its first publish makes the sequence even and non-zero
+    PositionSlot& slot = reinterpret_cast<PositionSlot*>(header_ + 1)[index];
+    slot.shard = shard;
+    slot.session_id.store(session_id, std::memory_order_relaxed);
+    slot.instrument_id.store(instrument_id, std::memory_order_relaxed);
+    return &slot;
+}
+
+PositionBoardReader::~PositionBoardReader() {
+    if (header_ != nullptr) {
+        munmap(const_cast<PositionBoardHeader*>(header_), size_);
+    }
+}
+
+bool PositionBoardReader::open(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    std::string path = shm_path(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Can't open position board " << path << "\n";
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) < sizeof(PositionBoardHeader)) {
+        std::cerr << "Position board " << path << " is too small\n";
+        close(fd);
+        return false;
+    }
+    size_ = status.st_size;
+    void* memory = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    header_ = static_cast<const PositionBoardHeader*>(memory);
+    if (header_->magic != PositionBoardHeader::MAGIC || header_->version != PositionBoardHeader::VERSION ||
+        board_size(header_->capacity) != size_) {
+        std::cerr << "Shared memory segment " << path << " is not a RiskServer position board\n";
+        return false;
+    }
+    slots_ = slots_of(header_);
+    return true;
+}
+
+size_t PositionBoardReader::slot_count() const {
+    uint64_t count = header_->slot_count.load(std::memory_order_acquire);
+    return count < header_->capacity ? count : header_->capacity;
+}
+
+bool PositionBoardReader::read(size_t index, PositionSample& sample) const {
+    const PositionSlot& slot = slots_[index];
+    for (int spins = 0; spins < MAX_READ_SPINS; ++spins) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if ((before & 1) == 0) {
+            sample.session_id = slot.session_id.load(std::memory_order_relaxed);
+            sample.instrument_id = slot.instrument_id.load(std::memory_order_relaxed);
+            sample.net_position = slot.net_position.load(std::memory_order_relaxed);
+            sample.buy_qty = slot.buy_qty.load(std::memory_order_relaxed);
+            sample.sell_qty = slot.sell_qty.load(std::memory_order_relaxed);
+            sample.updates = slot.updates.load(std::memory_order_relaxed);
+            sample.shard = slot.shard;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        ++retries_;
+        utils::cpu_relax();
+    }
+    return false;
+}
+
+void PositionBoardReader::sample(std::vector<PositionSample>& samples) const {
+    samples.clear();
+    size_t count = slot_count();
+    PositionSample sample;
+    for (size_t i = 0; i < count; ++i) {
+        if (read(i, sample)) {
+            samples.push_back(sample);
+        }
+    }
+}
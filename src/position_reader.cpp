@@ -0,0 +1,170 @@
+//position_reader.cpp
+//
+//This file implements RiskPositions, which reads the live instrument counters a
+//RiskServer publishes with --positions, without any syscall or lock on the
+//server's side.
+//
+//By default it prints one table of every published instrument. With --interval
+//it prints a new table every interval, and with --measure it samples the whole
+//board back to back for a number of seconds and reports how fast it can, along
+//with how often a read had to be retried because a shard was writing the slot.
+//
+//Usage: RiskPositions <board> [--session <id>] [--interval <ms>] [--count <n>] [--measure <seconds>]
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "position_board.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ReaderConfig {
+    std::string board;
+    bool all_sessions = true;
+    uint64_t session_id = 0;
+    int interval_ms = 0; //0 prints a single table
+    int count = 0;       //Tables to print with an interval; 0 for no limit
+    double measure_s = 0;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <board> [options]\n"
+              << "Options:\n"
+              << "  --session <id>         Only show this session's instruments\n"
+              << "  --interval <ms>        Print a new table every <ms> milliseconds\n"
+              << "  --count <n>            Tables to print with --interval (default 0 = until killed)\n"
+              << "  --measure <seconds>    Sample the board back to back and report the sampling rate\n";
+}
+
+bool parse_count(const char* text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parse_reader_config(int argc, char* argv[], ReaderConfig& config) {
+    if (argc < 2 || argv[1][0] == '-') {
+        return false;
+    }
+    config.board = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        const char* option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+
+        bool ok = false;
+        char* end = nullptr;
+        if (std::strcmp(option, "--session") == 0) {
+            config.session_id = std::strtoull(value, &end, 10);
+            config.all_sessions = false;
+            ok = end != value && *end == '\0';
+        } else if (std::strcmp(option, "--interval") == 0) {
+            ok = parse_count(value, config.interval_ms);
+        } else if (std::strcmp(option, "--count") == 0) {
+            ok = parse_count(value, config.count);
+        } else if (std::strcmp(option, "--measure") == 0) {
+            config.measure_s = std::strtod(value, &end);
+            ok = end != value && *end == '\0' && config.measure_s > 0;
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid value for " << option << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_table(const ReaderConfig& config, const PositionBoardReader& reader,
+                 const std::vector<PositionSample>& samples) {
+    std::cout << std::left << std::setw(10) << "Session" << std::setw(16) << "Instrument" << std::right
+              << std::setw(14) << "Net position" << std::setw(12) << "Buy qty" << std::setw(12) << "Sell qty"
+              << std::setw(12) << "Updates" << std::setw(7) << "Shard" << "\n";
+    for (const PositionSample& sample : samples) {
+        if (!config.all_sessions && sample.session_id != config.session_id) {
+            continue;
+        }
+        std::cout << std::left << std::setw(10) << sample.session_id << std::setw(16) << sample.instrument_id
+                  << std::right << std::setw(14) << sample.net_position << std::setw(12) << sample.buy_qty
+                  << std::setw(12) << sample.sell_qty << std::setw(12) << sample.updates << std::setw(7)
+                  << sample.shard << "\n";
+    }
+    if (reader.dropped() > 0) {
+        std::cout << reader.dropped() << " instruments are missing: the board is full\n";
+    }
+    std::cout << "\n";
+}
+
+void measure(const ReaderConfig& config, const PositionBoardReader& reader) {
+    std::vector<PositionSample> samples;
+    uint64_t passes = 0;
+    uint64_t slots = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(config.measure_s);
+    auto now = start;
+    while (now < deadline) {
+        //Checking the clock every pass would cost more than a small board
+        for (int i = 0; i < 64; ++i) {
+            reader.sample(samples);
+            slots += samples.size();
+        }
+        passes += 64;
+        now = std::chrono::steady_clock::now();
+    }
+    double seconds = std::chrono::duration<double>(now - start).count();
+    std::cout << "Sampled the board " << passes << " times in " << seconds << " s: "
+              << static_cast<uint64_t>(passes / seconds) << " snapshots/s, "
+              << std::setprecision(3) << seconds * 1e9 / passes << " ns per snapshot of "
+              << (passes > 0 ? slots / passes : 0) << " instruments\n"
+              << "Retried reads: " << reader.retries() << "\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ReaderConfig config;
+    if (!parse_reader_config(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    PositionBoardReader reader;
+    if (!reader.open(config.board)) {
+        return 1;
+    }
+
+    if (config.measure_s > 0) {
+        measure(config, reader);
+        return 0;
+    }
+
+    std::vector<PositionSample> samples;
+    for (int printed = 0; config.count == 0 || printed < config.count; ++printed) {
+        reader.sample(samples);
+        print_table(config, reader, samples);
+        if (config.interval_ms == 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.interval_ms));
+    }
+    return 0;
+}
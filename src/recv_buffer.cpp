@@ -0,0 +1,64 @@
+//recv_buffer.cpp
+//
+//This file implements the RecvBuffer class, which frames the messages of a
+//TCP byte stream using Header.payload_size.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "recv_buffer.h"
+
+#include <cstring>
+
+RecvBuffer::RecvBuffer(size_t capacity) : capacity_(capacity) {}
+
+char* RecvBuffer::write_ptr() {
+    if (data_.empty()) {
+        data_.resize(capacity_);
+    }
+
+    //Move the partial frame (if any) to the front so the free space is contiguous
+    if (head_ > 0) {
+        size_t remaining = tail_ - head_;
+        if (remaining > 0) {
+            memmove(data_.data(), data_.data() + head_, remaining);
+        }
+        head_ = 0;
+        tail_ = remaining;
+    }
+    return data_.data() + tail_;
+}
+
+size_t RecvBuffer::writable() const {
+    return capacity_ - tail_;
+}
+
+void RecvBuffer::commit(size_t size) {
+    tail_ += size;
+}
+
+RecvBuffer::FrameStatus RecvBuffer::next_frame(const char*& frame, size_t& size) {
+    size_t available = tail_ - head_;
+    if (available < sizeof(Header)) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    Header header;
+    memcpy(&header, data_.data() + head_, sizeof(Header));
+    size_t frame_size = sizeof(Header) + header.payload_size;
+    if (frame_size > capacity_) {
+        return FrameStatus::MALFORMED;
+    }
+    if (available < frame_size) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    frame = data_.data() + head_;
+    size = frame_size;
+    head_ += frame_size;
+    if (head_ == tail_) {
+        head_ = 0;
+        tail_ = 0;
+    }
+    return FrameStatus::COMPLETE;
+}
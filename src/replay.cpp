@@ -0,0 +1,582 @@
+//replay.cpp
+//
+//This file implements the replay engine: reading recorded flow from journals,
+//wire captures and JSON lines, and running it through State under many
+//configurations of limits.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "replay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <thread>
+
+#include "journal.h"
+#include "state.h"
+
+namespace {
+
+//Guards against a range typo turning into billions of replays
+constexpr size_t MAX_CONFIGS = 100000;
+
+struct LimitField {
+    const char* key;
+    void (*set)(RiskLimits& limits, int64_t value);
+    int64_t (*get)(const RiskLimits& limits);
+};
+
+constexpr LimitField LIMIT_FIELDS[] = {
+    {"buy", [](RiskLimits& l, int64_t v) { l.max_buy_position = v; },
+     [](const RiskLimits& l) { return l.max_buy_position; }},
+    {"sell", [](RiskLimits& l, int64_t v) { l.max_sell_position = v; },
+     [](const RiskLimits& l) { return l.max_sell_position; }},
+    {"order-qty", [](RiskLimits& l, int64_t v) { l.max_order_qty = v; },
+     [](const RiskLimits& l) { return static_cast<int64_t>(l.max_order_qty); }},
+    {"notional", [](RiskLimits& l, int64_t v) { l.max_notional = v; },
+     [](const RiskLimits& l) { return static_cast<int64_t>(l.max_notional); }},
+    {"collar", [](RiskLimits& l, int64_t v) { l.price_collar_bps = v; },
+     [](const RiskLimits& l) { return static_cast<int64_t>(l.price_collar_bps); }},
+    {"account-position", [](RiskLimits& l, int64_t v) { l.max_account_position = v; },
+     [](const RiskLimits& l) { return l.max_account_position; }},
+    {"account-notional", [](RiskLimits& l, int64_t v) { l.max_account_notional = v; },
+     [](const RiskLimits& l) { return l.max_account_notional; }},
+};
+
+bool parse_int64(const std::string& text, int64_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool parse_uint64(const std::string& text, uint64_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (text.empty() || text[0] == '-' || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+//Values of one limit: a single number or "<first>:<last>:<step>"
+bool parse_limit_values(const std::string& text, std::vector<int64_t>& values) {
+    size_t first_colon = text.find(':');
+    if (first_colon == std::string::npos) {
+        int64_t value;
+        if (!parse_int64(text, value) || value < 0) {
+            return false;
+        }
+        values.push_back(value);
+        return true;
+    }
+    size_t second_colon = text.find(':', first_colon + 1);
+    int64_t first;
+    int64_t last;
+    int64_t step;
+    if (second_colon == std::string::npos || !parse_int64(text.substr(0, first_colon), first) ||
+        !parse_int64(text.substr(first_colon + 1, second_colon - first_colon - 1), last) ||
+        !parse_int64(text.substr(second_colon + 1), step) || first < 0 || last < first || step <= 0 ||
+        (last - first) / step >= static_cast<int64_t>(MAX_CONFIGS)) {
+        return false;
+    }
+    for (int64_t value = first; value <= last; value += step) {
+        values.push_back(value);
+        if (last - value < step) {
+            break;
+        }
+    }
+    return true;
+}
+
+//Splits a flat JSON object into its keys and values. String values lose their
+//quotes; anything else (numbers, true, false, null) is kept as written.
+bool parse_flat_object(const std::string& line, std::vector<std::pair<std::string, std::string>>& fields) {
+    size_t i = 0;
+    auto skip_space = [&] {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) {
+            ++i;
+        }
+    };
+    auto read_string = [&](std::string& text) {
+        if (i >= line.size() || line[i] != '"') {
+            return false;
+        }
+        size_t end = line.find('"', i + 1);
+        //Escapes never appear in the fields of a message
+        if (end == std::string::npos || line.find('\\', i + 1) < end) {
+            return false;
+        }
+        text = line.substr(i + 1, end - i - 1);
+        i = end + 1;
+        return true;
+    };
+
+    fields.clear();
+    skip_space();
+    if (i >= line.size() || line[i++] != '{') {
+        return false;
+    }
+    skip_space();
+    if (i < line.size() && line[i] == '}') {
+        ++i;
+    } else {
+        while (true) {
+            std::string key;
+            std::string value;
+            skip_space();
+            if (!read_string(key)) {
+                return false;
+            }
+            skip_space();
+            if (i >= line.size() || line[i++] != ':') {
+                return false;
+            }
+            skip_space();
+            if (i < line.size() && line[i] == '"') {
+                if (!read_string(value)) {
+                    return false;
+                }
+            } else {
+                size_t start = i;
+                while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '-' ||
+                                           line[i] == '+' || line[i] == '.')) {
+                    ++i;
+                }
+                if (i == start) {
+                    return false;
+                }
+                value = line.substr(start, i - start);
+            }
+            fields.emplace_back(std::move(key), std::move(value));
+            skip_space();
+            if (i < line.size() && line[i] == ',') {
+                ++i;
+                continue;
+            }
+            if (i < line.size() && line[i] == '}') {
+                ++i;
+                break;
+            }
+            return false;
+        }
+    }
+    skip_space();
+    return i == line.size();
+}
+
+//Copies a wire or journal payload into the message. Returns false if it is too short.
+bool copy_payload(uint16_t message_type, const char* payload, size_t size, ReplayMessage& message) {
+    size_t needed = 0;
+    switch (message_type) {
+        case NewOrder::MESSAGE_TYPE:
+            needed = sizeof(NewOrder);
+            break;
+        case DeleteOrder::MESSAGE_TYPE:
+            needed = sizeof(DeleteOrder);
+            break;
+        case ModifyOrderQty::MESSAGE_TYPE:
+            needed = sizeof(ModifyOrderQty);
+            break;
+        case Trade::MESSAGE_TYPE:
+            needed = sizeof(Trade);
+            break;
+        default:
+            return false;
+    }
+    if (size < needed) {
+        return false;
+    }
+    message.message_type = message_type;
+    memcpy(&message.new_order, payload, needed);
+    return true;
+}
+
+}
+
+bool load_replay_file(const std::string& path, std::vector<ReplayMessage>& messages) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Can't open " << path << "\n";
+        return false;
+    }
+    char start[64] = {};
+    file.read(start, sizeof(start));
+    size_t length = static_cast<size_t>(file.gcount());
+
+    uint32_t magic = 0;
+    if (length >= sizeof(magic)) {
+        memcpy(&magic, start, sizeof(magic));
+    }
+    if (magic == JournalFileHeader::MAGIC) {
+        return load_journal(path, messages);
+    }
+    size_t first = 0;
+    while (first < length && std::isspace(static_cast<unsigned char>(start[first]))) {
+        ++first;
+    }
+    if (first < length && start[first] == '{') {
+        return load_json_lines(path, messages);
+    }
+    return load_wire_capture(path, messages);
+}
+
+bool load_journal(const std::string& path, std::vector<ReplayMessage>& messages) {
+    JournalReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Can't read journal " << path << "\n";
+        return false;
+    }
+    const JournalRecordHeader* record;
+    const char* payload;
+    ReplayMessage message{};
+    while (reader.next(record, payload)) {
+        message.session_id = record->session_id;
+        if (record->message_type == ReplayMessage::CANCEL_ALL) {
+            message.message_type = ReplayMessage::CANCEL_ALL;
+        } else if (record->message_type == Logon::MESSAGE_TYPE) {
+            //The limits being replayed replace the session's own
+            continue;
+        } else if (!copy_payload(record->message_type, payload, record->payload_size, message)) {
+            std::cerr << "Journal " << path << " holds a malformed record at offset " << reader.offset() << "\n";
+            return false;
+        }
+        messages.push_back(message);
+    }
+    return true;
+}
+
+bool load_wire_capture(const std::string& path, std::vector<ReplayMessage>& messages) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Can't open " << path << "\n";
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint64_t session_id = 0;
+    size_t offset = 0;
+    size_t skipped = 0;
+    ReplayMessage message{};
+    while (data.size() - offset >= sizeof(Header)) {
+        Header header;
+        memcpy(&header, data.data() + offset, sizeof(header));
+        if (data.size() - offset - sizeof(header) < header.payload_size) {
+            break;
+        }
+        const char* payload = data.data() + offset + sizeof(header);
+        offset += sizeof(header) + header.payload_size;
+
+        uint16_t message_type = 0;
+        if (header.payload_size >= sizeof(message_type)) {
+            memcpy(&message_type, payload, sizeof(message_type));
+        }
+        if (message_type == Logon::MESSAGE_TYPE && header.payload_size >= sizeof(Logon)) {
+            Logon logon;
+            memcpy(&logon, payload, sizeof(logon));
+            session_id = logon.session_id;
+            continue;
+        }
+        if (!copy_payload(message_type, payload, header.payload_size, message)) {
+            ++skipped;
+            continue;
+        }
+        message.session_id = session_id;
+        messages.push_back(message);
+    }
+    if (offset != data.size()) {
+        std::cerr << "Capture " << path << " ends in a partial message; its last " << data.size() - offset
+                  << " bytes were ignored\n";
+    }
+    if (skipped > 0) {
+        std::cerr << "Capture " << path << ": skipped " << skipped << " messages that are not orders or trades\n";
+    }
+    return true;
+}
+
+bool load_json_lines(const std::string& path, std::vector<ReplayMessage>& messages) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Can't open " << path << "\n";
+        return false;
+    }
+    std::string line;
+    ReplayMessage message{};
+    for (size_t number = 1; std::getline(file, line); ++number) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        if (!parse_replay_json(line, message)) {
+            std::cerr << path << ":" << number << ": not a message: " << line << "\n";
+            return false;
+        }
+        messages.push_back(message);
+    }
+    return true;
+}
+
+bool parse_replay_json(const std::string& line, ReplayMessage& message) {
+    std::vector<std::pair<std::string, std::string>> fields;
+    if (!parse_flat_object(line, fields)) {
+        return false;
+    }
+
+    std::string type;
+    std::string side;
+    uint64_t session_id = 0;
+    uint64_t instrument_id = 0;
+    uint64_t order_id = 0;
+    uint64_t trade_id = 0;
+    uint64_t price = 0;
+    int64_t qty = 0;
+    for (const auto& [key, value] : fields) {
+        bool ok = true;
+        if (key == "type") {
+            type = value;
+        } else if (key == "side") {
+            side = value;
+        } else if (key == "session") {
+            ok = parse_uint64(value, session_id);
+        } else if (key == "instrument") {
+            ok = parse_uint64(value, instrument_id);
+        } else if (key == "order_id") {
+            ok = parse_uint64(value, order_id);
+        } else if (key == "trade_id") {
+            ok = parse_uint64(value, trade_id);
+        } else if (key == "price") {
+            ok = parse_uint64(value, price);
+        } else if (key == "qty") {
+            ok = parse_int64(value, qty);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    message = ReplayMessage{};
+    message.session_id = session_id;
+    if (type == "new") {
+        if (qty < 0 || (side != "B" && side != "S")) {
+            return false;
+        }
+        message.message_type = NewOrder::MESSAGE_TYPE;
+        message.new_order = {NewOrder::MESSAGE_TYPE, instrument_id, order_id, static_cast<uint64_t>(qty), price,
+                             side[0]};
+    } else if (type == "delete") {
+        message.message_type = DeleteOrder::MESSAGE_TYPE;
+        message.delete_order = {DeleteOrder::MESSAGE_TYPE, order_id};
+    } else if (type == "modify") {
+        if (qty < 0) {
+            return false;
+        }
+        message.message_type = ModifyOrderQty::MESSAGE_TYPE;
+        message.modify_order = {ModifyOrderQty::MESSAGE_TYPE, order_id, static_cast<uint64_t>(qty)};
+    } else if (type == "trade") {
+        message.message_type = Trade::MESSAGE_TYPE;
+        message.trade = {Trade::MESSAGE_TYPE, instrument_id, trade_id, qty, price};
+    } else if (type == "cancel_all") {
+        message.message_type = ReplayMessage::CANCEL_ALL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse_limits_spec(const std::string& spec, std::vector<RiskLimits>& configs) {
+    std::vector<RiskLimits> expanded(1);
+    bool has_buy = false;
+    bool has_sell = false;
+
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string item = spec.substr(start, end - start);
+        start = end + 1;
+
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            std::cerr << "Expected <key>=<value> in limits: " << item << "\n";
+            return false;
+        }
+        std::string key = item.substr(0, equals);
+        const LimitField* field = nullptr;
+        for (const LimitField& candidate : LIMIT_FIELDS) {
+            if (key == candidate.key) {
+                field = &candidate;
+            }
+        }
+        std::vector<int64_t> values;
+        if (field == nullptr || !parse_limit_values(item.substr(equals + 1), values)) {
+            std::cerr << "Invalid limit: " << item << "\n";
+            return false;
+        }
+        has_buy |= key == "buy";
+        has_sell |= key == "sell";
+
+        if (expanded.size() * values.size() > MAX_CONFIGS) {
+            std::cerr << "Limits " << spec << " expand to more than " << MAX_CONFIGS << " configurations\n";
+            return false;
+        }
+        std::vector<RiskLimits> combined;
+        combined.reserve(expanded.size() * values.size());
+        for (const RiskLimits& limits : expanded) {
+            for (int64_t value : values) {
+                combined.push_back(limits);
+                field->set(combined.back(), value);
+            }
+        }
+        expanded.swap(combined);
+    }
+
+    if (!has_buy || !has_sell) {
+        std::cerr << "Limits need buy and sell: " << spec << "\n";
+        return false;
+    }
+    configs.insert(configs.end(), expanded.begin(), expanded.end());
+    return true;
+}
+
+std::string format_limits(const RiskLimits& limits) {
+    std::string text;
+    for (const LimitField& field : LIMIT_FIELDS) {
+        int64_t value = field.get(limits);
+        bool threshold = std::strcmp(field.key, "buy") == 0 || std::strcmp(field.key, "sell") == 0;
+        if (value == 0 && !threshold) {
+            continue;
+        }
+        text += (text.empty() ? "" : ",") + std::string(field.key) + "=" + std::to_string(value);
+    }
+    return text;
+}
+
+namespace {
+
+//modify_order_if_accepted() leaves the instrument alone when the order is not resting
+constexpr uint64_t UNKNOWN_INSTRUMENT = UINT64_MAX;
+
+//One configuration's States while a pass is under way
+struct ReplayRun {
+    const RiskLimits* limits;
+    ReplayResult* result;
+    std::unordered_map<uint64_t, std::unique_ptr<State>> sessions;
+    uint64_t last_session_id = 0;
+    State* last_session = nullptr; //Consecutive messages mostly come from the same session
+};
+
+void apply(ReplayRun& run, const ReplayMessage& message, size_t max_orders, std::vector<uint64_t>& cancelled) {
+    if (run.last_session == nullptr || message.session_id != run.last_session_id) {
+        auto& state = run.sessions[message.session_id];
+        if (!state) {
+            state = std::make_unique<State>(*run.limits, max_orders);
+        }
+        run.last_session_id = message.session_id;
+        run.last_session = state.get();
+    }
+    State& state = *run.last_session;
+    ReplayResult& result = *run.result;
+
+    switch (message.message_type) {
+        case NewOrder::MESSAGE_TYPE: {
+            bool accepted = state.add_order_if_accepted(message.new_order);
+            ReplayCounts& counts = result.instruments[message.new_order.instrument_id];
+            ++(accepted ? counts.new_accepted : counts.new_rejected);
+            ++(accepted ? result.total.new_accepted : result.total.new_rejected);
+            break;
+        }
+        case DeleteOrder::MESSAGE_TYPE:
+            ++(state.delete_order(message.delete_order) ? result.deletes : result.unknown_orders);
+            break;
+        case ModifyOrderQty::MESSAGE_TYPE: {
+            uint64_t instrument_id = UNKNOWN_INSTRUMENT;
+            bool accepted = state.modify_order_if_accepted(message.modify_order, instrument_id);
+            if (instrument_id == UNKNOWN_INSTRUMENT) {
+                ++result.unknown_orders;
+                break;
+            }
+            ReplayCounts& counts = result.instruments[instrument_id];
+            ++(accepted ? counts.modify_accepted : counts.modify_rejected);
+            ++(accepted ? result.total.modify_accepted : result.total.modify_rejected);
+            break;
+        }
+        case Trade::MESSAGE_TYPE:
+            state.process_trade(message.trade);
+            ++result.trades;
+            break;
+        case ReplayMessage::CANCEL_ALL:
+            state.cancel_all_orders(cancelled);
+            cancelled.clear();
+            break;
+    }
+}
+
+//Walks the messages once, applying each to every configuration of `runs` in turn
+void replay_pass(const std::vector<ReplayMessage>& messages, std::vector<ReplayRun>& runs, size_t max_orders) {
+    std::vector<uint64_t> cancelled;
+    auto start = std::chrono::steady_clock::now();
+    for (const ReplayMessage& message : messages) {
+        for (ReplayRun& run : runs) {
+            apply(run, message, max_orders, cancelled);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (ReplayRun& run : runs) {
+        run.result->seconds = seconds;
+    }
+}
+
+}
+
+ReplayResult replay(const std::vector<ReplayMessage>& messages, const RiskLimits& limits, size_t max_orders) {
+    ReplayResult result;
+    std::vector<ReplayRun> runs(1);
+    runs[0].limits = &limits;
+    runs[0].result = &result;
+    replay_pass(messages, runs, max_orders);
+    return result;
+}
+
+std::vector<ReplayResult> replay_all(const std::vector<ReplayMessage>& messages, const std::vector<RiskLimits>& configs,
+                                     size_t max_orders, size_t threads) {
+    std::vector<ReplayResult> results(configs.size());
+    threads = std::max<size_t>(1, std::min(threads, configs.size()));
+
+    //Each thread takes an even share of the configurations and makes a single pass for all of them
+    auto work = [&](size_t thread) {
+        size_t first = configs.size() * thread / threads;
+        size_t last = configs.size() * (thread + 1) / threads;
+        std::vector<ReplayRun> runs(last - first);
+        for (size_t i = first; i < last; ++i) {
+            runs[i - first].limits = &configs[i];
+            runs[i - first].result = &results[i];
+        }
+        replay_pass(messages, runs, max_orders);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
@@ -0,0 +1,206 @@
+//replay_tool.cpp
+//
+//This file implements RiskReplay, which answers "what would these limits have
+//done with yesterday's flow?" without a server. It loads journals, wire
+//captures or JSON lines once (see replay.h), replays them through State under
+//every configuration of limits given, spread over a pool of threads, and
+//reports how many new orders and modifies each configuration accepted and
+//rejected, in total and per instrument.
+//
+//Usage: RiskReplay --limits <spec> [--limits <spec> ...] [options] <file>...
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "replay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "state.h"
+
+namespace {
+
+struct ReplayConfig {
+    std::vector<std::string> files;
+    std::vector<RiskLimits> limits;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_orders = State::DEFAULT_MAX_ORDERS;
+    bool per_instrument = true;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " --limits <spec> [options] <file>...\n"
+              << "Replays journals, wire captures or JSON lines through State under each set of limits.\n"
+              << "Options:\n"
+              << "  --limits <spec>        Limits to replay under, e.g. buy=25,sell=20,order-qty=100; a value\n"
+              << "                         may be a range <first>:<last>:<step>. May be given many times.\n"
+              << "                         Keys: buy, sell, order-qty, notional, collar, account-position,\n"
+              << "                         account-notional\n"
+              << "  --limits-file <path>   Read one limits spec per line ('#' starts a comment)\n"
+              << "  --threads <n>          Configurations replayed at once (default: one per core)\n"
+              << "  --max-orders <n>       Resting orders per session (default 65536), as --max-orders\n"
+              << "  --report <mode>        instruments (default) adds a table per configuration, summary does not\n";
+}
+
+bool parse_count(const char* text, size_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || parsed <= 0 || errno == ERANGE) {
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+bool read_limits_file(const char* path, std::vector<RiskLimits>& limits) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Can't open " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        line.erase(std::remove_if(line.begin(), line.end(), is_space), line.end());
+        if (!line.empty() && !parse_limits_spec(line, limits)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parse_replay_config(int argc, char* argv[], ReplayConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const char* option = argv[i];
+        if (std::strncmp(option, "--", 2) != 0) {
+            config.files.push_back(option);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+
+        bool ok = false;
+        if (std::strcmp(option, "--limits") == 0) {
+            ok = parse_limits_spec(value, config.limits);
+        } else if (std::strcmp(option, "--limits-file") == 0) {
+            ok = read_limits_file(value, config.limits);
+        } else if (std::strcmp(option, "--threads") == 0) {
+            ok = parse_count(value, config.threads);
+        } else if (std::strcmp(option, "--max-orders") == 0) {
+            ok = parse_count(value, config.max_orders) && config.max_orders <= OrderPool::MAX_CAPACITY;
+        } else if (std::strcmp(option, "--report") == 0) {
+            ok = std::strcmp(value, "instruments") == 0 || std::strcmp(value, "summary") == 0;
+            config.per_instrument = std::strcmp(value, "instruments") == 0;
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid value for " << option << ": " << value << "\n";
+            return false;
+        }
+    }
+    if (config.files.empty() || config.limits.empty()) {
+        std::cerr << "Give at least one file and one --limits\n";
+        return false;
+    }
+    return true;
+}
+
+void print_counts_header(const char* first_column, size_t width) {
+    std::cout << std::left << std::setw(width) << first_column << std::right << std::setw(14) << "New accepted"
+              << std::setw(14) << "New rejected" << std::setw(17) << "Modify accepted" << std::setw(17)
+              << "Modify rejected";
+}
+
+void print_counts(const ReplayCounts& counts) {
+    std::cout << std::setw(14) << counts.new_accepted << std::setw(14) << counts.new_rejected << std::setw(17)
+              << counts.modify_accepted << std::setw(17) << counts.modify_rejected;
+}
+
+void print_summary(const ReplayConfig& config, const std::vector<ReplayResult>& results) {
+    size_t width = 16;
+    for (const RiskLimits& limits : config.limits) {
+        width = std::max(width, format_limits(limits).size() + 2);
+    }
+    print_counts_header("Configuration", width);
+    std::cout << std::setw(16) << "Unknown orders" << "\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::cout << std::left << std::setw(width) << format_limits(config.limits[i]) << std::right;
+        print_counts(results[i].total);
+        std::cout << std::setw(16) << results[i].unknown_orders << "\n";
+    }
+}
+
+void print_instruments(const RiskLimits& limits, const ReplayResult& result) {
+    std::vector<uint64_t> instruments;
+    instruments.reserve(result.instruments.size());
+    for (const auto& [instrument_id, counts] : result.instruments) {
+        instruments.push_back(instrument_id);
+    }
+    std::sort(instruments.begin(), instruments.end());
+
+    std::cout << "\n" << format_limits(limits) << "\n";
+    print_counts_header("Instrument", 16);
+    std::cout << "\n";
+    for (uint64_t instrument_id : instruments) {
+        std::cout << std::left << std::setw(16) << instrument_id << std::right;
+        print_counts(result.instruments.at(instrument_id));
+        std::cout << "\n";
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ReplayConfig config;
+    if (!parse_replay_config(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    auto load_start = std::chrono::steady_clock::now();
+    std::vector<ReplayMessage> messages;
+    for (const std::string& file : config.files) {
+        if (!load_replay_file(file, messages)) {
+            return 1;
+        }
+    }
+    double load_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+    std::cout << "Loaded " << messages.size() << " messages from " << config.files.size() << " files in "
+              << load_ms << " ms\n";
+
+    size_t threads = std::min(config.threads, config.limits.size());
+    auto replay_start = std::chrono::steady_clock::now();
+    std::vector<ReplayResult> results = replay_all(messages, config.limits, config.max_orders, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count();
+
+    double replayed = static_cast<double>(messages.size()) * results.size();
+    std::cout << "Replayed " << results.size() << " configurations on " << threads << " threads in " << seconds
+              << " s (" << static_cast<uint64_t>(seconds > 0 ? replayed / seconds : 0) << " messages/s)\n\n";
+
+    print_summary(config, results);
+    if (config.per_instrument) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            print_instruments(config.limits[i], results[i]);
+        }
+    }
+    return 0;
+}
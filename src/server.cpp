@@ -8,76 +8,480 @@
 
 #include "server.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <csignal>
 #include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
 #include <thread>
 #include <unistd.h>
 
+#include "latency_stats.h"
+#include "logger.h"
+#include "message_view.h"
+#include "utils.h"
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+
+//Requests a gateway loop processes before it drains responses again
+constexpr size_t GATEWAY_BATCH = 256;
+
+//How often an idle gateway loop checks that its gateway process is still alive
+constexpr int GATEWAY_LIVENESS_MS = 100;
+
+//Defaults for everything but session 0's position limits
+ServerConfig limits_only(int max_buy_position, int max_sell_position) {
+    ServerConfig config;
+    config.max_buy_position = max_buy_position;
+    config.max_sell_position = max_sell_position;
+    return config;
+}
+
+#ifdef RISK_IO_URING
+//Submission slots per ring; a full queue is submitted early, so this only sets the batch size
+constexpr unsigned RING_ENTRIES = 1024;
+
+//Provided receive buffers per loop; a pipelined burst fills a buffer per completion
+constexpr unsigned RECV_BUFFER_COUNT = 256;
+constexpr unsigned RECV_BUFFER_SIZE = 16 * 1024;
+
+//The low bits of a completion's user_data tell which operation of a connection it belongs to
+constexpr uint64_t OP_POLL = 0; //Also accepts, which only listeners submit
+constexpr uint64_t OP_RECV = 1;
+constexpr uint64_t OP_SEND = 2;
+constexpr uint64_t OP_CANCEL = 3;
+constexpr uint64_t OP_MASK = 3;
+
+template <typename Connection>
+uint64_t user_data(Connection* connection, uint64_t operation) {
+    return reinterpret_cast<uint64_t>(connection) | operation;
+}
+#endif
+
+}
+
 RiskServer::RiskServer(int max_buy_position, int max_sell_position)
-    : state_(max_buy_position, max_sell_position) {}
+    : RiskServer(limits_only(max_buy_position, max_sell_position)) {}
+
+RiskServer::RiskServer(const ServerConfig& config)
+    : config_(config),
+      response_socket_(-1) {}
+
+RiskServer::~RiskServer() {
+    for (auto& loop : loops_) {
+        if (loop->epoll_fd != -1) {
+            close(loop->epoll_fd);
+        }
+        if (loop->wakeup_fd != -1) {
+            close(loop->wakeup_fd);
+        }
+    }
+}
 
 bool RiskServer::init() {
-    if (!setup_socket(order_socket_, 55555)) {
-        std::cerr << "Can't bind to order IP/port!\n";
+    TscClock::calibrate();
+
+    if (!setup_event_loops()) {
+        std::cerr << "Can't create the event loops!\n";
+        return false;
+    }
+    if (!setup_listeners()) {
+        return false;
+    }
+    if (config_.io_backend == IoBackend::URING) {
+#ifdef RISK_IO_URING
+        if (!setup_uring()) {
+            std::cerr << "io_uring is not available (needs Linux 6.1), falling back to epoll\n";
+        }
+#else
+        std::cerr << "Built without io_uring (RISK_IO_URING), falling back to epoll\n";
+#endif
+    }
+    if (!config_.journal_dir.empty() &&
+        !shards_->open_journals(config_.journal_dir, config_.journal_sync, config_.journal_sync_interval_ms,
+                                config_.snapshot_interval_s)) {
+        std::cerr << "Can't recover from the journal!\n";
+        return false;
+    }
+    if (!config_.position_board.empty() &&
+        !shards_->open_position_board(config_.position_board, config_.position_board_capacity)) {
+        std::cerr << "Can't create the position board!\n";
+        return false;
+    }
+    return true;
+}
+
+bool RiskServer::setup_event_loops() {
+    size_t thread_count = std::max(config_.io_threads, 1);
+    size_t gateway_count = config_.shm_gateways.size();
+    RiskLimits limits{config_.max_buy_position, config_.max_sell_position, config_.max_order_qty,
+                      config_.max_notional, config_.price_collar_bps, config_.max_account_position,
+                      config_.max_account_notional};
+    shards_ = std::make_unique<ShardPool>(std::max(config_.shards, 1), thread_count + gateway_count, limits,
+                                          config_.max_orders, config_.shard_cores);
+    for (const SessionLimits& session : config_.sessions) {
+        shards_->add_session(session.session_id, session.max_buy_position, session.max_sell_position);
+    }
+    shards_->set_scheduling(config_.sched_fifo_priority, config_.busy_poll_us > 0);
+    socket_loops_ = thread_count;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto loop = std::make_unique<EventLoop>();
+        loop->index = i;
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epoll_fd < 0 || loop->wakeup_fd < 0) {
+            return false;
+        }
+
+        loop->wakeup = {loop->wakeup_fd, Connection::Kind::WAKEUP, false, loop.get()};
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = &loop->wakeup;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wakeup_fd, &event) < 0) {
+            return false;
+        }
+
+        loop->responses = {shards_->response_fd(i), Connection::Kind::RESPONSES, false, loop.get()};
+        event.data.ptr = &loop->responses;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->responses.socket, &event) < 0) {
+            return false;
+        }
+        //A busy-polling loop checks for responses every round, so spare the shards the eventfd write
+        if (config_.busy_poll_us > 0) {
+            shards_->set_response_doorbell(i, &loop->response_doorbell);
+        }
+        loops_.push_back(std::move(loop));
+    }
+
+    //Gateway loops poll their segment instead of an epoll instance; the shards wake
+    //them through the request ring's doorbell, which the gateway rings as well
+    for (size_t i = 0; i < gateway_count; ++i) {
+        auto loop = std::make_unique<EventLoop>();
+        loop->index = thread_count + i;
+        loop->gateway = std::make_unique<ShmSegment>();
+        if (!loop->gateway->create(config_.shm_gateways[i])) {
+            return false;
+        }
+        shards_->set_response_doorbell(loop->index, &loop->gateway->layout()->requests.doorbell());
+        loops_.push_back(std::move(loop));
+    }
+
+    for (size_t i = 0; i < loops_.size() && i < config_.io_cores.size(); ++i) {
+        loops_[i]->core = config_.io_cores[i];
+    }
+
+    //The first loop also takes the signals and the trade feed
+    EventLoop& acceptor = *loops_.front();
+
+    //SIGUSR1 (latency report) and SIGUSR2 (snapshot) are delivered through a signalfd;
+    //block them before any loop thread is started so the threads inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd < 0) {
         return false;
     }
-    if (!setup_socket(trade_socket_, 55556)) {
-        std::cerr << "Can't bind to trade IP/port!\n";
+    signal_ = {signal_fd, Connection::Kind::SIGNAL, false, &acceptor};
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = &signal_;
+    if (epoll_ctl(acceptor.epoll_fd, EPOLL_CTL_ADD, signal_fd, &event) < 0) {
         return false;
     }
+    return config_.trade_feed_address.empty() || setup_trade_feed(acceptor);
+}
+
+bool RiskServer::setup_listeners() {
+    //Either the first loop accepts for everyone, or every socket loop joins a
+    //SO_REUSEPORT group per port and keeps the connections the kernel gives it
+    bool reuse_port = config_.accept_mode == AcceptMode::REUSEPORT;
+    size_t listening_loops = reuse_port ? socket_loops_ : 1;
+
+    for (size_t i = 0; i < listening_loops; ++i) {
+        EventLoop& loop = *loops_[i];
+        int order_socket = -1;
+        int trade_socket = -1;
+        if (!setup_socket(order_socket, config_.order_port, reuse_port)) {
+            std::cerr << "Can't bind to order IP/port!\n";
+            return false;
+        }
+        if (!setup_socket(trade_socket, config_.trade_port, reuse_port)) {
+            std::cerr << "Can't bind to trade IP/port!\n";
+            return false;
+        }
+        loop.order_listener = {order_socket, Connection::Kind::ORDER_LISTENER, false, &loop};
+        loop.trade_listener = {trade_socket, Connection::Kind::TRADE_LISTENER, true, &loop};
+        loop.listening = true;
+
+        for (Connection* listener : {&loop.order_listener, &loop.trade_listener}) {
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLET;
+            event.data.ptr = listener;
+            if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, listener->socket, &event) < 0) {
+                std::cerr << "Can't register the listeners!\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool RiskServer::setup_trade_feed(EventLoop& loop) {
+    trade_feed_ = std::make_unique<TradeFeed>(config_.trade_feed_window);
+    if (!trade_feed_->open(config_.trade_feed_address, config_.trade_feed_port, config_.trade_feed_interface)) {
+        return false;
+    }
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        return false;
+    }
+
+    set_busy_poll(trade_feed_->socket_fd());
+
+    //Feed trades are booked like those of a trade connection that never logged on
+    trade_feed_connection_ = {trade_feed_->socket_fd(), Connection::Kind::TRADE_FEED, true, &loop};
+    trade_feed_connection_.messages = &TRADE_FEED_MESSAGES;
+    feed_timer_ = {timer_fd, Connection::Kind::FEED_TIMER, true, &loop};
+    for (Connection* source : {&trade_feed_connection_, &feed_timer_}) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = source;
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, source->socket, &event) < 0) {
+            return false;
+        }
+    }
     return true;
 }
 
 void RiskServer::run() {
-    fd_set master_set;
-    FD_ZERO(&master_set);
-    FD_SET(order_socket_, &master_set);
-    FD_SET(trade_socket_, &master_set);
+    running_ = true;
+    Logger::instance().start(config_.log_level);
+    shards_->start();
 
-    int max_sd = std::max(order_socket_, trade_socket_);
-    bool first_client_connected = false;
+    for (size_t i = 1; i < loops_.size(); ++i) {
+        loops_[i]->thread = std::thread(&RiskServer::run_event_loop, this, std::ref(*loops_[i]));
+    }
+    run_event_loop(*loops_.front());
+    for (size_t i = 1; i < loops_.size(); ++i) {
+        loops_[i]->thread.join();
+    }
 
-    while (true) {
-        fd_set working_set = master_set;
+    for (auto& loop : loops_) {
+#ifdef RISK_IO_URING
+        //Tear the ring down first, so no operation outlives the connection it points at
+        loop->ring.reset();
+        for (auto& [pointer, connection] : loop->retired) {
+            close(connection->socket);
+        }
+        loop->retired.clear();
+#endif
+        std::lock_guard<std::mutex> lock(loop->connections_mutex);
+        for (auto& [id, connection] : loop->connections) {
+            if (connection->socket != -1) {
+                close(connection->socket);
+            }
+        }
+        loop->connections.clear();
+        if (loop->listening) {
+            close(loop->order_listener.socket);
+            close(loop->trade_listener.socket);
+        }
+    }
+    shards_->stop();
+    Logger::instance().stop();
+
+    close(signal_.socket);
+    if (trade_feed_) {
+        close(feed_timer_.socket);
+        trade_feed_.reset();
+    }
+}
 
-        if (select(max_sd + 1, &working_set, nullptr, nullptr, nullptr) < 0) {
-            std::cerr << "Select failed!\n";
+void RiskServer::stop() {
+    running_ = false;
+    for (auto& loop : loops_) {
+        if (loop->gateway) {
+            loop->gateway->layout()->requests.doorbell().ring();
+            continue;
+        }
+        uint64_t one = 1;
+        if (write(loop->wakeup_fd, &one, sizeof(one)) < 0) {
+            std::cerr << "Failed to wake event loop!\n";
+        }
+    }
+}
+
+void RiskServer::run_event_loop(EventLoop& loop) {
+    //The first loop runs on the main thread, after the others were started, so they don't inherit its placement
+    utils::place_current_thread((loop.gateway ? "gateway-" : "io-") + std::to_string(loop.index), loop.core,
+                                config_.sched_fifo_priority);
+
+    if (loop.gateway) {
+        run_gateway_loop(loop);
+        return;
+    }
+#ifdef RISK_IO_URING
+    if (loop.ring) {
+        run_uring_loop(loop);
+        return;
+    }
+#endif
+    epoll_event events[MAX_EVENTS];
+
+    //Busy polling only looks at what is ready and never blocks
+    bool busy_poll = config_.busy_poll_us > 0;
+    int timeout = busy_poll ? 0 : -1;
+
+    while (running_) {
+        int ready = epoll_wait(loop.epoll_fd, events, MAX_EVENTS, timeout);
+        ++loop.syscalls;
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait failed!\n";
             break;
         }
 
-        for (int i = 0; i <= max_sd; ++i) {
-            if (FD_ISSET(i, &working_set)) {
-                if (i == order_socket_ || i == trade_socket_) {
-                    int client_socket = accept(i, nullptr, nullptr);
-                    if (client_socket < 0) {
-                        std::cerr << "Accept failed!\n";
-                        continue;
+        for (int i = 0; i < ready; ++i) {
+            auto* connection = static_cast<Connection*>(events[i].data.ptr);
+            switch (connection->kind) {
+                case Connection::Kind::ORDER_LISTENER:
+                case Connection::Kind::TRADE_LISTENER:
+                    accept_clients(*connection);
+                    break;
+                case Connection::Kind::WAKEUP: {
+                    uint64_t count;
+                    while (read(loop.wakeup_fd, &count, sizeof(count)) > 0) {
                     }
-
-                    if (!first_client_connected) {
-                        first_client_connected = true;
-                    } else {
-                        clear_screen();
-                        state_.reset();  
+                    break;
+                }
+                case Connection::Kind::SIGNAL:
+                    handle_signals(*connection);
+                    break;
+                case Connection::Kind::TRADE_FEED:
+                    read_trade_feed(*connection);
+                    break;
+                case Connection::Kind::FEED_TIMER:
+                    skip_trade_feed_gap(*connection);
+                    break;
+                case Connection::Kind::RESPONSES: {
+                    uint64_t count;
+                    while (read(connection->socket, &count, sizeof(count)) > 0) {
                     }
-
-                    std::thread(&RiskServer::handle_client, this, client_socket, i == trade_socket_).detach();
+                    drain_responses(loop);
+                    break;
+                }
+                case Connection::Kind::GATEWAY:
+                    //Served by its own thread, never registered with epoll
+                    break;
+                case Connection::Kind::CLIENT: {
+                    bool alive = !(events[i].events & EPOLLERR);
+                    if (alive && (events[i].events & EPOLLOUT)) {
+                        alive = flush_output(*connection);
+                    }
+                    if (alive && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))) {
+                        alive = read_client(*connection);
+                    }
+                    if (!alive) {
+                        close_client(connection);
+                    }
+                    break;
                 }
             }
         }
+
+        //The shards ring the loop's doorbell rather than its eventfd, so look for responses every round
+        if (busy_poll && shards_->responses_waiting(loop.index)) {
+            drain_responses(loop);
+        }
+
+        //One send per connection covers every response produced this round
+        flush_responses(loop);
+
+        if (ready == 0) {
+            utils::cpu_relax();
+        }
     }
+}
 
-    close(order_socket_);
-    close(trade_socket_);
+void RiskServer::read_trade_feed(Connection& connection) {
+    connection.recv_tsc = TscClock::now();
+    if (!trade_feed_->receive([this, &connection](const char* frame, size_t size) {
+            process_message(frame, size, connection);
+        })) {
+        std::cerr << "Trade feed receive failed!\n";
+    }
+    arm_feed_timer();
+}
+
+void RiskServer::skip_trade_feed_gap(Connection& timer) {
+    uint64_t expirations;
+    while (read(timer.socket, &expirations, sizeof(expirations)) > 0) {
+    }
+    feed_timer_armed_ = false;
+
+    //The missing trades are given up on; the ones held behind them are applied now
+    Connection& connection = trade_feed_connection_;
+    connection.recv_tsc = TscClock::now();
+    trade_feed_->skip_gap([this, &connection](const char* frame, size_t size) {
+        process_message(frame, size, connection);
+    });
+    arm_feed_timer();
 }
 
-bool RiskServer::setup_socket(int& socket, int port) {
-    socket = ::socket(AF_INET, SOCK_STREAM, 0);
+void RiskServer::arm_feed_timer() {
+    if (trade_feed_->has_gap() == feed_timer_armed_) {
+        return;
+    }
+    //One-shot from when the gap was first seen; zero disarms
+    feed_timer_armed_ = trade_feed_->has_gap();
+    itimerspec timeout{};
+    if (feed_timer_armed_) {
+        timeout.it_value.tv_sec = config_.trade_feed_gap_ms / 1000;
+        timeout.it_value.tv_nsec = (config_.trade_feed_gap_ms % 1000) * 1'000'000L;
+    }
+    timerfd_settime(feed_timer_.socket, 0, &timeout, nullptr);
+}
+
+void RiskServer::handle_signals(Connection& signal) {
+    signalfd_siginfo info;
+    while (read(signal.socket, &info, sizeof(info)) > 0) {
+        if (info.ssi_signo == SIGUSR1) {
+            report_latency();
+        } else if (config_.journal_dir.empty()) {
+            std::cerr << "Snapshots need --journal\n";
+        } else {
+            shards_->request_snapshot();
+        }
+    }
+}
+
+bool RiskServer::setup_socket(int& socket, int port, bool reuse_port) {
+    socket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (socket < 0) {
         return false;
     }
 
+    int reuse = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (reuse_port && setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        return false;
+    }
+
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
@@ -94,122 +498,783 @@ bool RiskServer::setup_socket(int& socket, int port) {
     return true;
 }
 
-void RiskServer::handle_client(int client_socket, bool is_trade_socket) {
-    char buffer[4096];
+void RiskServer::set_busy_poll(int socket) {
+    if (config_.busy_poll_us == 0) {
+        return;
+    }
+    if (setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &config_.busy_poll_us, sizeof(config_.busy_poll_us)) < 0 &&
+        !busy_poll_warned_) {
+        //Going above net.core.busy_poll needs CAP_NET_ADMIN; the loops spin regardless
+        std::cerr << "Can't set SO_BUSY_POLL on the sockets: " << std::strerror(errno) << "\n";
+        busy_poll_warned_ = true;
+    }
+}
+
+void RiskServer::accept_clients(const Connection& listener) {
+    //Edge-triggered: keep accepting until the backlog is empty
     while (true) {
-        ssize_t bytes_received = recv(client_socket, buffer, sizeof(buffer), 0);
-        if (bytes_received <= 0) {
-            close(client_socket);
-            break;
+        int client_socket = accept4(listener.socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Accept failed!\n";
+            }
+            return;
         }
 
-        process_message(buffer, bytes_received, client_socket, is_trade_socket);
+        add_client(listener, client_socket);
     }
 }
 
-void RiskServer::process_message(const char* buffer, size_t size, int client_socket, bool is_trade_socket) {
-    if (size < sizeof(Header)) {
-        std::cerr << "Received message is too small\n";
+void RiskServer::add_client(const Connection& listener, int client_socket) {
+    //A listener of its own means the kernel already chose this loop; otherwise deal the connection out
+    EventLoop& loop = config_.accept_mode == AcceptMode::REUSEPORT ? *listener.loop
+                                                                    : *loops_[next_loop_++ % socket_loops_];
+    bool is_trade_socket = listener.is_trade_socket;
+    ++loop.accepted;
+    set_busy_poll(client_socket);
+    auto owner = std::make_unique<Connection>(client_socket, Connection::Kind::CLIENT, is_trade_socket, &loop);
+    Connection* connection = owner.get();
+    connection->id = next_connection_id_++;
+    connection->messages = is_trade_socket ? &TRADE_PORT_MESSAGES : &ORDER_PORT_MESSAGES;
+    if (!connection->is_trade_socket) {
+        shards_->attach(connection->session_id);
+    }
+    {
+        std::lock_guard<std::mutex> lock(loop.connections_mutex);
+        loop.connections.emplace(connection->id, std::move(owner));
+    }
+
+#ifdef RISK_IO_URING
+    //Only the owning loop may submit to its ring, so hand the connection over unless it accepted it
+    if (loop.ring && &loop == listener.loop) {
+        start_client(loop, *connection);
         return;
     }
+    if (loop.ring) {
+        {
+            std::lock_guard<std::mutex> lock(loop.new_clients_mutex);
+            loop.new_clients.push_back(connection);
+        }
+        uint64_t one = 1;
+        if (write(loop.wakeup_fd, &one, sizeof(one)) < 0) {
+            std::cerr << "Failed to wake event loop!\n";
+        }
+        return;
+    }
+#endif
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = connection;
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0) {
+        std::cerr << "Failed to register client socket!\n";
+        close(client_socket);
+        if (!connection->is_trade_socket) {
+            shards_->detach(connection->session_id);
+        }
+        std::lock_guard<std::mutex> lock(loop.connections_mutex);
+        loop.connections.erase(connection->id);
+    }
+}
+
+bool RiskServer::read_client(Connection& connection) {
+    RecvBuffer& buffer = connection.recv_buffer;
+    while (true) {
+        ssize_t bytes_received = recv(connection.socket, buffer.write_ptr(), buffer.writable(), 0);
+        ++connection.loop->syscalls;
+        if (bytes_received == 0) {
+            return false;
+        }
+        if (bytes_received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        buffer.commit(bytes_received);
+        connection.recv_tsc = TscClock::now();
+        if (!process_frames(connection)) {
+            return false;
+        }
+    }
+}
 
-    Header header;
-    memcpy(&header, buffer, sizeof(Header));
+bool RiskServer::process_frames(Connection& connection) {
+    //Process every complete message of this read as one batch
+    const char* frame;
+    size_t frame_size;
+    RecvBuffer::FrameStatus status;
+    while ((status = connection.recv_buffer.next_frame(frame, frame_size)) == RecvBuffer::FrameStatus::COMPLETE) {
+        process_message(frame, frame_size, connection);
+    }
+    if (status == RecvBuffer::FrameStatus::MALFORMED) {
+        std::cerr << "Received message exceeds the receive buffer, closing connection\n";
+        return false;
+    }
+    return true;
+}
 
-    const char* message_buffer = buffer + sizeof(Header);
-    size_t message_size = size - sizeof(Header);
+bool RiskServer::flush_output(Connection& connection) {
+    if (!connection.awaiting_writable) {
+        //Not waiting on the socket; write_output sends whatever is queued
+        return true;
+    }
+    if (connection.flush_queued) {
+        //Part of the output is still being batched; flush_responses sends it
+        watch_writable(connection, false);
+        return true;
+    }
+
+    while (!connection.pending_output.empty()) {
+        ssize_t sent = send(connection.socket, connection.pending_output.data(),
+                            connection.pending_output.size(), MSG_NOSIGNAL);
+        ++connection.loop->syscalls;
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.pending_output.erase(0, sent);
+    }
+
+    //Everything went out, stop asking for writability
+    watch_writable(connection, false);
+    return true;
+}
+
+void RiskServer::watch_writable(Connection& connection, bool writable) {
+    connection.awaiting_writable = writable;
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (writable ? EPOLLOUT : 0u);
+    event.data.ptr = &connection;
+    epoll_ctl(connection.loop->epoll_fd, EPOLL_CTL_MOD, connection.socket, &event);
+    ++connection.loop->syscalls;
+}
 
-    if (is_trade_socket) {
-        if (message_size < sizeof(Trade)) {
-            std::cerr << "Invalid trade message size\n";
+void RiskServer::write_output(Connection& connection) {
+    if (connection.kind == Connection::Kind::GATEWAY) {
+        write_gateway_output(connection);
+        return;
+    }
+#ifdef RISK_IO_URING
+    //One send at a time keeps the responses in order; its completion sends what queued up meanwhile
+    if (connection.loop->ring) {
+        if (connection.send_in_flight || connection.closing || connection.pending_output.empty()) {
             return;
         }
+        connection.inflight_output.swap(connection.pending_output);
+        connection.send_in_flight = true;
+        ++connection.pending_ops;
+        connection.loop->ring->prep_send(connection.socket, connection.inflight_output.data(),
+                                         connection.inflight_output.size(), user_data(&connection, OP_SEND));
+        return;
+    }
+#endif
 
-        Trade trade;
-        memcpy(&trade, message_buffer, sizeof(Trade));
-        state_.process_trade(trade);
-        std::cout << "Processed Trade: Instrument " << trade.instrument_id
-                  << ", Quantity " << trade.trade_qty << ", Price " << trade.trade_price << "\n";
-        state_.print_instrument_state(trade.instrument_id);
-    } else {
-        uint16_t message_type;
-        memcpy(&message_type, message_buffer, sizeof(uint16_t));
+    //Already waiting for EPOLLOUT, which sends everything once the socket drains
+    if (connection.awaiting_writable) {
+        return;
+    }
 
-        if (message_type == NewOrder::MESSAGE_TYPE) {
-            if (message_size < sizeof(NewOrder)) {
-                std::cerr << "Invalid new order message size\n";
-                return;
+    size_t offset = 0;
+    while (offset < connection.pending_output.size()) {
+        ssize_t sent = send(connection.socket, connection.pending_output.data() + offset,
+                            connection.pending_output.size() - offset, MSG_NOSIGNAL);
+        ++connection.loop->syscalls;
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-
-            NewOrder new_order;
-            memcpy(&new_order, message_buffer, sizeof(NewOrder));
-
-            bool order_accepted = state_.add_order_if_accepted(new_order);
-            send_response(client_socket, {OrderResponse::MESSAGE_TYPE, new_order.order_id,
-                                          order_accepted ? OrderResponse::Status::ACCEPTED : OrderResponse::Status::REJECTED});
-            std::cout << "\nProcessed New Order: Instrument " << new_order.instrument_id
-                      << ", Quantity " << new_order.order_qty << ", Price " << new_order.order_price
-                      << ", Side " << (new_order.side == 'B' ? "Buy" : "Sell") 
-                      << ", Status " << (order_accepted ? "Accepted" : "Rejected") << "\n";
-            state_.print_instrument_state(new_order.instrument_id);
-        } else if (message_type == DeleteOrder::MESSAGE_TYPE) {
-            if (message_size < sizeof(DeleteOrder)) {
-                std::cerr << "Invalid delete order message size\n";
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                //The peer is gone; reading the socket will close the connection
+                connection.pending_output.clear();
                 return;
             }
+            break;
+        }
+        offset += sent;
+    }
+    connection.pending_output.erase(0, offset);
+    if (connection.pending_output.empty()) {
+        return;
+    }
 
-            DeleteOrder delete_order;
-            memcpy(&delete_order, message_buffer, sizeof(DeleteOrder));
+    //The socket buffer is full: keep the remainder and wait for EPOLLOUT
+    watch_writable(connection, true);
+}
 
-            bool order_deleted = state_.delete_order(delete_order);
-            send_response(client_socket, {OrderResponse::MESSAGE_TYPE, delete_order.order_id,
-                                          order_deleted ? OrderResponse::Status::ACCEPTED : OrderResponse::Status::REJECTED});
-            std::cout << "Processed Delete Order: Order ID " << delete_order.order_id << ", Status " 
-                      << (order_deleted ? "Deleted" : "Not Found") << "\n";
+void RiskServer::flush_responses(EventLoop& loop) {
+    for (Connection* connection : loop.unflushed) {
+        connection->flush_queued = false;
+        write_output(*connection);
+    }
+    loop.unflushed.clear();
+}
 
-            if (order_deleted) {
-                auto instrument_id = state_.find_instrument_id_by_order(delete_order.order_id);
-                if (instrument_id.has_value()) {
-                    state_.print_instrument_state(*instrument_id);
-                }
+void RiskServer::close_client(Connection* connection) {
+    EventLoop& loop = *connection->loop;
+
+    //Out of the map first, so no response drained below can reach it
+    std::unique_ptr<Connection> owner;
+    {
+        std::lock_guard<std::mutex> lock(loop.connections_mutex);
+        auto it = loop.connections.find(connection->id);
+        owner = std::move(it->second);
+        loop.connections.erase(it);
+    }
+    if (connection->flush_queued) {
+        loop.unflushed.erase(std::find(loop.unflushed.begin(), loop.unflushed.end(), connection));
+    }
+
+    //Requests this connection already queued are ahead of the cancel, so nothing it sent survives it
+    if (!connection->is_trade_socket && shards_->detach(connection->session_id) &&
+        config_.on_disconnect == DisconnectPolicy::CANCEL) {
+        ShardRequest request{};
+        request.message_type = ShardRequest::CANCEL_ALL;
+        request.session_id = connection->session_id;
+        for (size_t shard = 0; shard < shards_->shard_count(); ++shard) {
+            while (!shards_->try_submit(loop.index, shard, request)) {
+                drain_responses(loop);
+                utils::cpu_relax();
             }
-        } else if (message_type == ModifyOrderQty::MESSAGE_TYPE) {
-            if (message_size < sizeof(ModifyOrderQty)) {
-                std::cerr << "Invalid modify order quantity message size\n";
-                return;
+        }
+    }
+
+    if (connection->kind == Connection::Kind::GATEWAY) {
+        return;
+    }
+#ifdef RISK_IO_URING
+    if (loop.ring) {
+        retire_client(loop, std::move(owner));
+        return;
+    }
+#endif
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, connection->socket, nullptr);
+    close(connection->socket);
+}
+
+void RiskServer::process_message(const char* buffer, size_t size, Connection& connection) {
+    if (size < FrameView::MIN_SIZE) {
+        std::cerr << "Received message is too small\n";
+        return;
+    }
+
+    ++connection.loop->messages;
+    FrameView frame(buffer);
+    uint16_t message_type = frame.message_type();
+
+    //The connection's port decides which types it may send
+    const MessageTable& messages = *connection.messages;
+    if (message_type >= messages.size() || messages[message_type].handler == nullptr) {
+        std::cerr << "Unexpected message type: " << message_type << "\n";
+        return;
+    }
+    const DispatchEntry<MessageHandler>& entry = messages[message_type];
+    if (size - sizeof(Header) < entry.size) {
+        std::cerr << "Invalid message size for message type " << message_type << "\n";
+        return;
+    }
+    (this->*entry.handler)(frame.payload(), connection);
+}
+
+template <typename Message>
+void RiskServer::handle_message(const char* message, Connection& connection) {
+    ShardRequest request{};
+    request.connection_id = connection.id;
+    request.session_id = connection.session_id;
+    request.recv_tsc = connection.recv_tsc;
+    request.message_type = Message::MESSAGE_TYPE;
+
+    //Copied once, straight from the receive buffer into the request
+    MessageView<Message> view(message);
+    if constexpr (std::is_same_v<Message, NewOrder>) {
+        view.copy_to(request.new_order);
+        submit_request(connection, request, request.new_order.order_id);
+    } else if constexpr (std::is_same_v<Message, DeleteOrder>) {
+        view.copy_to(request.delete_order);
+        submit_request(connection, request, request.delete_order.order_id);
+    } else if constexpr (std::is_same_v<Message, ModifyOrderQty>) {
+        view.copy_to(request.modify_order);
+        submit_request(connection, request, request.modify_order.order_id);
+    } else {
+        static_assert(std::is_same_v<Message, Trade>, "No ShardRequest field for this message");
+        view.copy_to(request.trade);
+        submit_request(connection, request, 0);
+    }
+}
+
+//Either port may log on; a trade connection then books its trades to that session
+template <>
+void RiskServer::handle_message<Logon>(const char* message, Connection& connection) {
+    Logon logon;
+    MessageView<Logon>(message).copy_to(logon);
+    bool accepted = !connection.logged_on && shards_->logon(logon.session_id);
+    if (accepted) {
+        if (!connection.is_trade_socket) {
+            shards_->attach(logon.session_id);
+            shards_->detach(connection.session_id);
+        }
+        connection.session_id = logon.session_id;
+        connection.logged_on = true;
+    } else {
+        std::cerr << "Rejected logon to session " << logon.session_id << "\n";
+    }
+    send_response(connection, {OrderResponse::MESSAGE_TYPE, logon.session_id,
+                               accepted ? OrderResponse::Status::ACCEPTED : OrderResponse::Status::REJECTED});
+}
+
+//Each port's table, built at compile time from the message structs it accepts
+const RiskServer::MessageTable RiskServer::ORDER_PORT_MESSAGES =
+    make_dispatch_table<MessageHandler, NewOrder, DeleteOrder, ModifyOrderQty, Logon>(
+        []<typename Message>() { return &RiskServer::handle_message<Message>; });
+const RiskServer::MessageTable RiskServer::TRADE_PORT_MESSAGES =
+    make_dispatch_table<MessageHandler, Trade, Logon>(
+        []<typename Message>() { return &RiskServer::handle_message<Message>; });
+const RiskServer::MessageTable RiskServer::TRADE_FEED_MESSAGES =
+    make_dispatch_table<MessageHandler, Trade>([]<typename Message>() { return &RiskServer::handle_message<Message>; });
+
+void RiskServer::submit_request(Connection& connection, ShardRequest& request, uint64_t order_id) {
+    size_t shard;
+    if (!shards_->route(request, shard)) {
+        //Unknown or duplicate order ID: no shard can accept it
+        Logger& logger = Logger::instance();
+        if (logger.enabled(LogLevel::WARN)) {
+            LogEvent event{};
+            event.message_type = request.message_type;
+            event.order_id = order_id;
+            if (request.message_type == NewOrder::MESSAGE_TYPE) {
+                event.instrument_id = request.new_order.instrument_id;
+                event.quantity = request.new_order.order_qty;
+                event.price = request.new_order.order_price;
+                event.side = request.new_order.side;
+            } else if (request.message_type == ModifyOrderQty::MESSAGE_TYPE) {
+                event.quantity = request.modify_order.new_qty;
             }
+            logger.log(event);
+        }
+        send_response(connection, {OrderResponse::MESSAGE_TYPE, order_id, OrderResponse::Status::REJECTED});
+        return;
+    }
+
+    request.submit_tsc = TscClock::now();
+    LatencyStats::instance().record(request.message_type, LatencyStats::PARSE, request.submit_tsc - request.recv_tsc);
+
+    //Keep delivering responses while the shard's queue is full, or the shard could block on us
+    EventLoop& loop = *connection.loop;
+    while (!shards_->try_submit(loop.index, shard, request)) {
+        drain_responses(loop);
+        utils::cpu_relax();
+    }
+}
+
+void RiskServer::drain_responses(EventLoop& loop) {
+    std::lock_guard<std::mutex> lock(loop.connections_mutex);
+    shards_->drain_responses(loop.index, [this, &loop](const ShardResponse& response) {
+        auto it = loop.connections.find(response.connection_id);
+        if (it != loop.connections.end()) {
+            //Timed when queued; the flush follows at the end of this round
+            send_response(*it->second, response.response);
+            uint64_t sent_tsc = TscClock::now();
+            LatencyStats& latency = LatencyStats::instance();
+            latency.record(response.message_type, LatencyStats::RESPOND, sent_tsc - response.respond_tsc);
+            latency.record(response.message_type, LatencyStats::TOTAL, sent_tsc - response.recv_tsc);
+        }
+    });
+}
 
-            ModifyOrderQty modify_order_qty;
-            memcpy(&modify_order_qty, message_buffer, sizeof(ModifyOrderQty));
+void RiskServer::report_latency() {
+    std::cout << "\nLatency report\n";
+    LatencyStats::instance().report(std::cout);
 
-            bool modify_accepted = state_.modify_order_if_accepted(modify_order_qty);
-            send_response(client_socket, {OrderResponse::MESSAGE_TYPE, modify_order_qty.order_id,
-                                          modify_accepted ? OrderResponse::Status::ACCEPTED : OrderResponse::Status::REJECTED});
+    const char* backend = "epoll";
+    uint64_t syscalls = 0;
+    uint64_t messages = 0;
+    for (auto& loop : loops_) {
+        syscalls += loop->syscalls.load(std::memory_order_relaxed);
+        messages += loop->messages.load(std::memory_order_relaxed);
+#ifdef RISK_IO_URING
+        if (loop->ring) {
+            backend = "io_uring";
+            syscalls += loop->ring->enter_calls();
+        }
+#endif
+    }
+    std::cout << "Network syscalls: " << syscalls << " for " << messages << " messages ("
+              << (messages > 0 ? static_cast<double>(syscalls) / messages : 0.0) << " per message, "
+              << backend << ")\n";
+    std::cout << "Connections accepted per loop:";
+    for (size_t i = 0; i < socket_loops_; ++i) {
+        std::cout << " " << loops_[i]->accepted.load(std::memory_order_relaxed);
+    }
+    std::cout << "\n";
+    if (trade_feed_) {
+        const SequenceTracker::Stats& feed = trade_feed_->stats();
+        std::cout << "Trade feed: " << trade_feed_->datagrams() << " datagrams in " << trade_feed_->syscalls()
+                  << " reads, " << feed.delivered << " trades applied, " << feed.reordered << " reordered, "
+                  << feed.duplicates << " duplicates, " << feed.gaps << " gaps (" << feed.lost
+                  << " trades lost), " << trade_feed_->malformed() + feed.oversized << " malformed\n";
+    }
+    std::cout << "Log events dropped: " << Logger::instance().dropped() << "\n" << std::flush;
+}
 
-            std::cout << "Processed Modify Order Quantity: Order ID " << modify_order_qty.order_id
-                      << ", New Quantity " << modify_order_qty.new_qty << ", Status " 
-                      << (modify_accepted ? "Accepted" : "Rejected") << "\n";
+void RiskServer::send_response(Connection& connection, const OrderResponse& response) {
+    connection.pending_output.append(reinterpret_cast<const char*>(&response), sizeof(OrderResponse));
 
-            if (modify_accepted) {
-                auto instrument_id = state_.find_instrument_id_by_order(modify_order_qty.order_id);
-                if (instrument_id.has_value()) {
-                    state_.print_instrument_state(*instrument_id);
+    //A full batch goes out straight away, so a long drain cannot hold responses back
+    if (connection.pending_output.size() >= config_.response_batch * sizeof(OrderResponse)) {
+        write_output(connection);
+        return;
+    }
+    if (!connection.flush_queued) {
+        connection.flush_queued = true;
+        connection.loop->unflushed.push_back(&connection);
+    }
+}
+
+void RiskServer::clear_screen() {
+    std::cout << "\n\n\n";
+}
+
+void RiskServer::run_gateway_loop(EventLoop& loop) {
+    ShmGatewayLayout& gateway = *loop.gateway->layout();
+    ShmRing& requests = gateway.requests;
+    Connection* connection = nullptr;
+    uint64_t liveness_tsc = TscClock::now();
+
+    while (running_) {
+        uint32_t state = gateway.state.load(std::memory_order_acquire);
+        if (connection == nullptr && state != ShmGatewayLayout::FREE) {
+            connection = open_gateway_client(loop);
+        }
+
+        //Requests are processed in place, straight out of their slots
+        bool busy = false;
+        if (connection != nullptr) {
+            connection->recv_tsc = TscClock::now();
+            const ShmRing::Slot* slot;
+            for (size_t i = 0; i < GATEWAY_BATCH && (slot = requests.front()) != nullptr; ++i) {
+                //The size was written by the gateway process, so it is not trusted
+                if (slot->size > ShmRing::SLOT_DATA) {
+                    std::cerr << "Gateway on " << loop.gateway->name() << " sent a slot of " << slot->size
+                              << " bytes\n";
                 } else {
-                    std::cout << "Instrument ID for Order ID " << modify_order_qty.order_id << " not found.\n";
+                    process_message(slot->data, slot->size, *connection);
                 }
+                requests.pop();
+                busy = true;
             }
+        }
+        if (shards_->responses_waiting(loop.index)) {
+            drain_responses(loop);
+            busy = true;
+        }
+        flush_responses(loop);
+        if (connection != nullptr && !connection->pending_output.empty()) {
+            //The response ring is full; keep trying while the gateway catches up
+            write_output(*connection);
+            busy = true;
+        }
+
+        //CLOSING was published after the gateway's last request, so once the ring is
+        //empty everything it sent has been processed, just like a TCP stream up to its FIN
+        if (connection != nullptr && state == ShmGatewayLayout::CLOSING && requests.empty()) {
+            close_client(connection);
+            connection = nullptr;
+            requests.reset();
+            gateway.responses.reset();
+            gateway.client_pid.store(0, std::memory_order_relaxed);
+            gateway.state.store(ShmGatewayLayout::FREE, std::memory_order_release);
+            continue;
+        }
+        if (busy) {
+            continue;
+        }
+
+        if (config_.shm_wait == ShmWait::FUTEX && config_.busy_poll_us == 0) {
+            requests.doorbell().wait(
+                [this, &loop, &requests, &gateway, state] {
+                    return !requests.empty() || shards_->responses_waiting(loop.index) ||
+                           gateway.state.load(std::memory_order_acquire) != state;
+                },
+                GATEWAY_LIVENESS_MS);
         } else {
-            std::cerr << "Unknown message type: " << message_type << "\n";
+            utils::cpu_relax();
+        }
+
+        //A gateway that died without detaching is released like a dropped connection
+        uint64_t now = TscClock::now();
+        if (TscClock::to_ns(now - liveness_tsc) < GATEWAY_LIVENESS_MS * 1'000'000ULL) {
+            continue;
+        }
+        liveness_tsc = now;
+        pid_t pid = gateway.client_pid.load(std::memory_order_acquire);
+        if (state == ShmGatewayLayout::ATTACHED && pid > 0 && kill(pid, 0) < 0 && errno == ESRCH) {
+            std::cerr << "Gateway on " << loop.gateway->name() << " exited without detaching\n";
+            uint32_t expected = ShmGatewayLayout::ATTACHED;
+            gateway.state.compare_exchange_strong(expected, ShmGatewayLayout::CLOSING);
         }
     }
 }
 
-void RiskServer::send_response(int client_socket, const OrderResponse& response) {
-    char buffer[sizeof(OrderResponse)];
-    memcpy(buffer, &response, sizeof(OrderResponse));
-    send(client_socket, buffer, sizeof(OrderResponse), 0);
+RiskServer::Connection* RiskServer::open_gateway_client(EventLoop& loop) {
+    auto owner = std::make_unique<Connection>(-1, Connection::Kind::GATEWAY, false, &loop);
+    Connection* connection = owner.get();
+    connection->id = next_connection_id_++;
+    connection->messages = &ORDER_PORT_MESSAGES;
+    shards_->attach(connection->session_id);
+    std::lock_guard<std::mutex> lock(loop.connections_mutex);
+    loop.connections.emplace(connection->id, std::move(owner));
+    return connection;
 }
 
-void RiskServer::clear_screen() {
-    std::cout << "\n\n\n";
+void RiskServer::write_gateway_output(Connection& connection) {
+    ShmRing& responses = connection.loop->gateway->layout()->responses;
+    size_t offset = 0;
+    while (offset < connection.pending_output.size() &&
+           responses.try_push(connection.pending_output.data() + offset, sizeof(OrderResponse))) {
+        offset += sizeof(OrderResponse);
+    }
+    if (offset > 0) {
+        connection.pending_output.erase(0, offset);
+        responses.doorbell().ring();
+    }
+}
+
+#ifdef RISK_IO_URING
+bool RiskServer::setup_uring() {
+    for (size_t i = 0; i < socket_loops_; ++i) {
+        auto& loop = loops_[i];
+        loop->ring = std::make_unique<IoUring>();
+        if (!loop->ring->init(RING_ENTRIES, RECV_BUFFER_COUNT, RECV_BUFFER_SIZE)) {
+            for (auto& created : loops_) {
+                created->ring.reset();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void RiskServer::run_uring_loop(EventLoop& loop) {
+    IoUring& ring = *loop.ring;
+    if (!ring.enable()) {
+        std::cerr << "Failed to enable io_uring!\n";
+        return;
+    }
+
+    //Multishot operations stay armed until they fail, so each is submitted once
+    ring.prep_multishot_poll(loop.wakeup_fd, user_data(&loop.wakeup, OP_POLL));
+    ring.prep_multishot_poll(loop.responses.socket, user_data(&loop.responses, OP_POLL));
+    if (loop.listening) {
+        ring.prep_multishot_accept(loop.order_listener.socket, user_data(&loop.order_listener, OP_POLL));
+        ring.prep_multishot_accept(loop.trade_listener.socket, user_data(&loop.trade_listener, OP_POLL));
+    }
+    if (&loop == loops_.front().get()) {
+        ring.prep_multishot_poll(signal_.socket, user_data(&signal_, OP_POLL));
+        if (trade_feed_) {
+            ring.prep_multishot_poll(trade_feed_connection_.socket, user_data(&trade_feed_connection_, OP_POLL));
+            ring.prep_multishot_poll(feed_timer_.socket, user_data(&feed_timer_, OP_POLL));
+        }
+    }
+
+    bool busy_poll = config_.busy_poll_us > 0;
+    while (running_) {
+        //Submits the sends and re-arms of the previous round and waits for the next completions
+        if (!(busy_poll ? ring.submit_and_poll() : ring.submit_and_wait())) {
+            std::cerr << "io_uring_enter failed!\n";
+            break;
+        }
+        unsigned completed =
+            ring.for_each_completion([this, &loop](const io_uring_cqe& cqe) { handle_completion(loop, cqe); });
+
+        if (busy_poll && shards_->responses_waiting(loop.index)) {
+            drain_responses(loop);
+        }
+
+        //One send per connection covers every response produced this round
+        flush_responses(loop);
+
+        if (busy_poll && completed == 0) {
+            utils::cpu_relax();
+        }
+    }
+}
+
+void RiskServer::handle_completion(EventLoop& loop, const io_uring_cqe& cqe) {
+    auto* connection = reinterpret_cast<Connection*>(cqe.user_data & ~OP_MASK);
+    uint64_t operation = cqe.user_data & OP_MASK;
+    bool rearm = !(cqe.flags & IORING_CQE_F_MORE);
+    IoUring& ring = *loop.ring;
+
+    switch (connection->kind) {
+        case Connection::Kind::ORDER_LISTENER:
+        case Connection::Kind::TRADE_LISTENER:
+            if (cqe.res >= 0) {
+                add_client(*connection, cqe.res);
+            } else {
+                std::cerr << "Accept failed!\n";
+            }
+            if (rearm) {
+                ring.prep_multishot_accept(connection->socket, cqe.user_data);
+            }
+            break;
+        case Connection::Kind::WAKEUP: {
+            uint64_t count;
+            while (read(loop.wakeup_fd, &count, sizeof(count)) > 0) {
+            }
+            start_clients(loop);
+            if (rearm) {
+                ring.prep_multishot_poll(connection->socket, cqe.user_data);
+            }
+            break;
+        }
+        case Connection::Kind::SIGNAL:
+            handle_signals(*connection);
+            if (rearm) {
+                ring.prep_multishot_poll(connection->socket, cqe.user_data);
+            }
+            break;
+        case Connection::Kind::TRADE_FEED:
+            read_trade_feed(*connection);
+            if (rearm) {
+                ring.prep_multishot_poll(connection->socket, cqe.user_data);
+            }
+            break;
+        case Connection::Kind::FEED_TIMER:
+            skip_trade_feed_gap(*connection);
+            if (rearm) {
+                ring.prep_multishot_poll(connection->socket, cqe.user_data);
+            }
+            break;
+        case Connection::Kind::RESPONSES: {
+            uint64_t count;
+            while (read(connection->socket, &count, sizeof(count)) > 0) {
+            }
+            ++loop.syscalls;
+            drain_responses(loop);
+            if (rearm) {
+                ring.prep_multishot_poll(connection->socket, cqe.user_data);
+            }
+            break;
+        }
+        case Connection::Kind::CLIENT:
+            handle_client_completion(loop, *connection, operation, cqe);
+            break;
+        case Connection::Kind::GATEWAY:
+            //Served by its own thread, never submitted to a ring
+            break;
+    }
+}
+
+void RiskServer::handle_client_completion(EventLoop& loop, Connection& connection, uint64_t operation,
+                                          const io_uring_cqe& cqe) {
+    IoUring& ring = *loop.ring;
+    switch (operation) {
+        case OP_RECV: {
+            bool alive = cqe.res > 0 || cqe.res == -ENOBUFS;
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                const char* data = ring.buffer(buffer_id);
+                size_t size = cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0;
+
+                //Copy into the connection's framing buffer, which keeps partial frames across receives
+                RecvBuffer& buffer = connection.recv_buffer;
+                connection.recv_tsc = TscClock::now();
+                while (alive && !connection.closing && size > 0) {
+                    char* destination = buffer.write_ptr();
+                    size_t chunk = std::min(size, buffer.writable());
+                    memcpy(destination, data, chunk);
+                    buffer.commit(chunk);
+                    data += chunk;
+                    size -= chunk;
+                    alive = process_frames(connection);
+                }
+                ring.recycle_buffer(buffer_id);
+            }
+
+            if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                connection.recv_armed = false;
+                --connection.pending_ops;
+            }
+            if (connection.closing) {
+                release_if_idle(loop, connection);
+            } else if (!alive) {
+                close_client(&connection);
+            } else if (!connection.recv_armed) {
+                //Ran out of provided buffers; they are recycled by now
+                connection.recv_armed = true;
+                ++connection.pending_ops;
+                ring.prep_multishot_recv(connection.socket, user_data(&connection, OP_RECV));
+            }
+            break;
+        }
+        case OP_SEND:
+            --connection.pending_ops;
+            if (connection.closing) {
+                release_if_idle(loop, connection);
+                break;
+            }
+            if (cqe.res > 0 && static_cast<size_t>(cqe.res) < connection.inflight_output.size()) {
+                //Short send: the rest goes out before anything queued behind it
+                connection.inflight_output.erase(0, cqe.res);
+                ++connection.pending_ops;
+                ring.prep_send(connection.socket, connection.inflight_output.data(),
+                               connection.inflight_output.size(), user_data(&connection, OP_SEND));
+                break;
+            }
+            //Done, or the peer is gone and the receive side will notice
+            connection.inflight_output.clear();
+            connection.send_in_flight = false;
+            if (cqe.res < 0) {
+                connection.pending_output.clear();
+            } else if (!connection.flush_queued) {
+                write_output(connection);
+            }
+            break;
+        case OP_CANCEL:
+            --connection.pending_ops;
+            release_if_idle(loop, connection);
+            break;
+    }
+}
+
+void RiskServer::start_clients(EventLoop& loop) {
+    std::vector<Connection*> clients;
+    {
+        std::lock_guard<std::mutex> lock(loop.new_clients_mutex);
+        clients.swap(loop.new_clients);
+    }
+    for (Connection* connection : clients) {
+        start_client(loop, *connection);
+    }
+}
+
+void RiskServer::start_client(EventLoop& loop, Connection& connection) {
+    connection.recv_armed = true;
+    ++connection.pending_ops;
+    loop.ring->prep_multishot_recv(connection.socket, user_data(&connection, OP_RECV));
+}
+
+void RiskServer::retire_client(EventLoop& loop, std::unique_ptr<Connection> owner) {
+    Connection& connection = *owner;
+    connection.closing = true;
+    loop.retired.emplace(&connection, std::move(owner));
+    if (connection.recv_armed) {
+        ++connection.pending_ops;
+        loop.ring->prep_cancel(user_data(&connection, OP_RECV), user_data(&connection, OP_CANCEL));
+    }
+    release_if_idle(loop, connection);
+}
+
+void RiskServer::release_if_idle(EventLoop& loop, Connection& connection) {
+    if (connection.pending_ops > 0) {
+        return;
+    }
+    close(connection.socket);
+    loop.retired.erase(&connection);
 }
+#endif
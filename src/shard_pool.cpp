@@ -0,0 +1,791 @@
+//shard_pool.cpp
+//
+//This file implements the ShardPool class, which runs the instrument-partitioned
+//State shards on their own worker threads.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "shard_pool.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "latency_stats.h"
+#include "logger.h"
+#include "utils.h"
+
+namespace {
+
+//Requests drained from one producer before moving on to the next
+constexpr size_t BATCH_SIZE = 256;
+
+//Empty polls before an idle shard goes to sleep on its doorbell
+constexpr int IDLE_SPINS = 10000;
+
+//Records a processed message, attaching the instrument's counters when asked to
+void log_event(const State& state, bool accepted, LogEvent event) {
+    Logger& logger = Logger::instance();
+    if (!logger.enabled(accepted ? LogLevel::INFO : LogLevel::WARN)) {
+        return;
+    }
+    event.accepted = accepted;
+    event.has_position = event.has_position && state.get_position(event.instrument_id, event.position);
+    logger.log(event);
+}
+
+}
+
+ShardPool::ShardPool(size_t shard_count, size_t producer_count, const RiskLimits& limits, size_t max_orders,
+                     const std::vector<int>& cores)
+    : limits_(limits), max_orders_(max_orders) {
+    sessions_.emplace(0, Session{limits.max_buy_position, limits.max_sell_position});
+
+    for (size_t p = 0; p < producer_count; ++p) {
+        auto producer = std::make_unique<Producer>();
+        producer->response_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        producers_.push_back(std::move(producer));
+    }
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<Shard>(i);
+        if (i < cores.size()) {
+            shard->core = cores[i];
+        }
+        for (size_t p = 0; p < producer_count; ++p) {
+            shard->requests.push_back(std::make_unique<SpscQueue<ShardRequest>>(QUEUE_CAPACITY));
+            shard->responses.push_back(std::make_unique<SpscQueue<ShardResponse>>(QUEUE_CAPACITY));
+        }
+        shard->responded.assign(producer_count, 0);
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ShardPool::~ShardPool() {
+    stop();
+    for (auto& producer : producers_) {
+        if (producer->response_fd != -1) {
+            close(producer->response_fd);
+        }
+    }
+}
+
+bool ShardPool::open_journals(const std::string& directory, JournalSync sync, int sync_interval_ms,
+                              int snapshot_interval_s) {
+    if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        std::cerr << "Failed to create journal directory " << directory << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    journal_dir_ = directory;
+    snapshot_interval_s_ = snapshot_interval_s;
+
+    //Every record was accepted once; the account totals are summed up after the last shard
+    recovering_ = true;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        size_t journal_offset = 0;
+        if (!load_snapshot(i, shard_path(i, ".snapshot"), journal_offset)) {
+            return false;
+        }
+
+        std::string path = shard_path(i, ".journal");
+        JournalReader reader;
+        if (!reader.open(path)) {
+            return false;
+        }
+
+        //Instruments are partitioned by the shard count, so a journal only fits the layout that wrote it
+        const JournalFileHeader* header = reader.header();
+        if (header != nullptr && (header->shard != i || header->shard_count != shards_.size())) {
+            std::cerr << "Journal " << path << " was written by shard " << header->shard << " of "
+                      << header->shard_count << "; restart with --shards " << header->shard_count << "\n";
+            return false;
+        }
+        if (journal_offset > 0 && !reader.skip_to(journal_offset)) {
+            std::cerr << "Journal " << path << " is shorter than its snapshot!\n";
+            return false;
+        }
+
+        size_t records = 0;
+        size_t skipped = 0;
+        const JournalRecordHeader* record;
+        const char* payload;
+        while (reader.next(record, payload)) {
+            replay_record(i, *record, payload, skipped);
+            ++records;
+        }
+        double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (journal_offset > 0 || records > 0) {
+            std::cout << "Recovered shard " << i << " from " << (journal_offset > 0 ? "a snapshot and " : "")
+                      << records << " journal records in " << elapsed_ms << " ms\n";
+        }
+        if (skipped > 0) {
+            std::cerr << skipped << " journal records for shard " << i
+                      << " no longer pass the risk checks and were skipped!\n";
+        }
+
+        auto journal = std::make_unique<Journal>();
+        if (!journal->open(path, reader.offset(), static_cast<uint16_t>(i), static_cast<uint16_t>(shards_.size()),
+                           sync, sync_interval_ms)) {
+            return false;
+        }
+        shards_[i]->journal = std::move(journal);
+    }
+
+    recovering_ = false;
+    for (auto& shard : shards_) {
+        for (auto& [session_id, state] : shard->sessions) {
+            state->resume_account_limits();
+        }
+    }
+    return true;
+}
+
+bool ShardPool::load_snapshot(size_t shard, const std::string& path, size_t& journal_offset) {
+    SnapshotReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    const SnapshotFileHeader* header = reader.header();
+    if (header == nullptr) {
+        return true;
+    }
+    if (header->shard != shard || header->shard_count != shards_.size()) {
+        std::cerr << "Snapshot " << path << " was written by shard " << header->shard << " of "
+                  << header->shard_count << "; restart with --shards " << header->shard_count << "\n";
+        return false;
+    }
+
+    Shard& target = *shards_[shard];
+    const SnapshotSession* session;
+    const SnapshotInstrument* instruments;
+    const SnapshotOrder* orders;
+    while (reader.next_session(session, instruments, orders)) {
+        //Sessions follow the limits they are configured with now, not the ones saved
+        if (!logon(session->session_id)) {
+            std::cerr << "Snapshot " << path << " holds session " << session->session_id
+                      << ", which is no longer configured; its orders are dropped!\n";
+            continue;
+        }
+        if (!session_state(target, session->session_id)
+                 .load_snapshot(instruments, session->instrument_count, orders, session->order_count)) {
+            std::cerr << "Snapshot " << path << " holds more orders than --max-orders allows!\n";
+            return false;
+        }
+        for (size_t i = 0; i < session->order_count; ++i) {
+            remember_order(session->session_id, orders[i].order_id, shard);
+        }
+    }
+    journal_offset = header->journal_offset;
+    return true;
+}
+
+std::string ShardPool::shard_path(size_t shard, const char* extension) const {
+    return journal_dir_ + "/shard-" + std::to_string(shard) + extension;
+}
+
+bool ShardPool::open_position_board(const std::string& name, size_t capacity) {
+    position_board_ = std::make_unique<PositionBoard>();
+    if (!position_board_->create(name, capacity)) {
+        position_board_.reset();
+        return false;
+    }
+    return true;
+}
+
+void ShardPool::publish_position(Shard& shard, uint64_t session_id, const State& state, uint64_t instrument_id) {
+    if (!position_board_) {
+        return;
+    }
+    State::Position position;
+    if (!state.get_position(instrument_id, position)) {
+        return;
+    }
+    auto [it, inserted] = shard.position_slots.try_emplace({session_id, instrument_id}, nullptr);
+    if (inserted) {
+        it->second = position_board_->claim(shard.index, session_id, instrument_id);
+    }
+    if (it->second != nullptr) {
+        PositionBoard::publish(*it->second, position.net_position, position.buy_qty, position.sell_qty);
+    }
+}
+
+void ShardPool::publish_session(Shard& shard, uint64_t session_id, const State& state) {
+    if (!position_board_) {
+        return;
+    }
+    state.for_each_position([&](uint64_t instrument_id, const State::Position&) {
+        publish_position(shard, session_id, state, instrument_id);
+    });
+}
+
+void ShardPool::request_snapshot() {
+    for (auto& shard : shards_) {
+        if (!shard->journal) {
+            continue;
+        }
+        shard->snapshot_requested.store(true);
+        shard->doorbell.fetch_add(1, std::memory_order_release);
+        shard->doorbell.notify_one();
+    }
+}
+
+void ShardPool::add_session(uint64_t session_id, int64_t max_buy_position, int64_t max_sell_position) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    sessions_.emplace(session_id, Session{max_buy_position, max_sell_position});
+}
+
+bool ShardPool::logon(uint64_t session_id) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    return sessions_.count(session_id) > 0;
+}
+
+void ShardPool::attach(uint64_t session_id) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    ++sessions_.at(session_id).connections;
+}
+
+bool ShardPool::detach(uint64_t session_id) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    return --sessions_.at(session_id).connections == 0;
+}
+
+State& ShardPool::session_state(Shard& shard, uint64_t session_id) {
+    if (shard.last_session != nullptr && shard.last_session_id == session_id) {
+        return *shard.last_session;
+    }
+
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) {
+        //The I/O thread registered the session before sending it anything
+        Session limits;
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            limits = sessions_.at(session_id);
+        }
+        RiskLimits session_limits = limits_;
+        session_limits.max_buy_position = limits.max_buy_position;
+        session_limits.max_sell_position = limits.max_sell_position;
+        it = shard.sessions
+                 .emplace(session_id, std::make_unique<State>(session_limits, max_orders_, limits.account.get()))
+                 .first;
+        if (recovering_) {
+            it->second->suspend_account_limits();
+        }
+
+        //Session 0 takes whatever defaults the server is started with, so it is never journaled
+        if (shard.journal && session_id != 0) {
+            shard.journal->append(session_id, Logon{Logon::MESSAGE_TYPE, session_id});
+        }
+    }
+    shard.last_session_id = session_id;
+    shard.last_session = it->second.get();
+    return *shard.last_session;
+}
+
+void ShardPool::cancel_all_orders(Shard& shard, uint64_t session_id) {
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) {
+        return;
+    }
+    std::vector<uint64_t> cancelled;
+    it->second->cancel_all_orders(cancelled);
+    for (uint64_t order_id : cancelled) {
+        forget_order(session_id, order_id);
+    }
+}
+
+void ShardPool::replay_record(size_t shard, const JournalRecordHeader& record, const char* payload, size_t& skipped) {
+    Shard& target = *shards_[shard];
+    uint64_t session_id = record.session_id;
+    if (record.message_type == Logon::MESSAGE_TYPE) {
+        Logon logon;
+        if (record.payload_size != sizeof(logon)) {
+            ++skipped;
+            return;
+        }
+        memcpy(&logon, payload, sizeof(logon));
+        if (!ShardPool::logon(session_id)) {
+            ++skipped;
+            return;
+        }
+        session_state(target, session_id);
+        return;
+    }
+    if (record.message_type == ShardRequest::CANCEL_ALL) {
+        cancel_all_orders(target, session_id);
+        return;
+    }
+
+    //Every other record follows its session's Logon
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        if (sessions_.count(session_id) == 0) {
+            ++skipped;
+            return;
+        }
+    }
+    //A record whose size does not match its type cannot be copied out
+    size_t expected_size = 0;
+    switch (record.message_type) {
+        case NewOrder::MESSAGE_TYPE:
+            expected_size = sizeof(NewOrder);
+            break;
+        case DeleteOrder::MESSAGE_TYPE:
+            expected_size = sizeof(DeleteOrder);
+            break;
+        case ModifyOrderQty::MESSAGE_TYPE:
+            expected_size = sizeof(ModifyOrderQty);
+            break;
+        case Trade::MESSAGE_TYPE:
+            expected_size = sizeof(Trade);
+            break;
+    }
+    if (expected_size == 0 || record.payload_size != expected_size) {
+        ++skipped;
+        return;
+    }
+
+    State& state = session_state(target, session_id);
+    switch (record.message_type) {
+        case NewOrder::MESSAGE_TYPE: {
+            NewOrder new_order;
+            memcpy(&new_order, payload, sizeof(new_order));
+            if (!state.add_order_if_accepted(new_order)) {
+                ++skipped;
+                break;
+            }
+            remember_order(session_id, new_order.order_id, shard);
+            break;
+        }
+        case DeleteOrder::MESSAGE_TYPE: {
+            DeleteOrder delete_order;
+            memcpy(&delete_order, payload, sizeof(delete_order));
+            if (!state.delete_order(delete_order)) {
+                ++skipped;
+                break;
+            }
+            forget_order(session_id, delete_order.order_id);
+            break;
+        }
+        case ModifyOrderQty::MESSAGE_TYPE: {
+            ModifyOrderQty modify_order;
+            memcpy(&modify_order, payload, sizeof(modify_order));
+            if (!state.modify_order_if_accepted(modify_order)) {
+                ++skipped;
+            }
+            break;
+        }
+        case Trade::MESSAGE_TYPE: {
+            Trade trade;
+            memcpy(&trade, payload, sizeof(trade));
+            state.process_trade(trade);
+            break;
+        }
+    }
+}
+
+void ShardPool::start() {
+    running_ = true;
+    for (auto& shard : shards_) {
+        shard->thread = std::thread(&ShardPool::run_shard, this, std::ref(*shard));
+    }
+    if (!journal_dir_.empty()) {
+        snapshot_thread_ = std::thread(&ShardPool::run_snapshot_writer, this);
+    }
+}
+
+void ShardPool::stop() {
+    running_ = false;
+    for (auto& shard : shards_) {
+        shard->doorbell.fetch_add(1);
+        shard->doorbell.notify_one();
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot_stop_ = true;
+    }
+    snapshot_cv_.notify_one();
+    if (snapshot_thread_.joinable()) {
+        snapshot_thread_.join();
+    }
+}
+
+bool ShardPool::route(const ShardRequest& request, size_t& shard) {
+    switch (request.message_type) {
+        case NewOrder::MESSAGE_TYPE: {
+            shard = shard_for_instrument(request.new_order.instrument_id);
+            RouterStripe& stripe = stripe_for(request.new_order.order_id);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            return stripe.shards.emplace(RouteKey{request.session_id, request.new_order.order_id}, shard).second;
+        }
+        case DeleteOrder::MESSAGE_TYPE:
+        case ModifyOrderQty::MESSAGE_TYPE: {
+            uint64_t order_id = request.message_type == DeleteOrder::MESSAGE_TYPE
+                                    ? request.delete_order.order_id
+                                    : request.modify_order.order_id;
+            RouterStripe& stripe = stripe_for(order_id);
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.shards.find(RouteKey{request.session_id, order_id});
+            if (it == stripe.shards.end()) {
+                return false;
+            }
+            shard = it->second;
+            return true;
+        }
+        case Trade::MESSAGE_TYPE:
+            shard = shard_for_instrument(request.trade.instrument_id);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ShardPool::try_submit(size_t producer, size_t shard, const ShardRequest& request) {
+    Shard& target = *shards_[shard];
+    if (!target.requests[producer]->try_push(request)) {
+        return false;
+    }
+    if (!busy_poll_) {
+        target.doorbell.fetch_add(1, std::memory_order_release);
+        target.doorbell.notify_one();
+    }
+    return true;
+}
+
+int ShardPool::response_fd(size_t producer) const {
+    return producers_[producer]->response_fd;
+}
+
+void ShardPool::set_response_doorbell(size_t producer, FutexDoorbell* doorbell) {
+    producers_[producer]->doorbell = doorbell;
+}
+
+void ShardPool::set_scheduling(int fifo_priority, bool busy_poll) {
+    fifo_priority_ = fifo_priority;
+    busy_poll_ = busy_poll;
+}
+
+size_t ShardPool::shard_for_instrument(uint64_t instrument_id) const {
+    //Fibonacci hashing spreads sequential instrument IDs evenly
+    return (instrument_id * 0x9E3779B97F4A7C15ULL >> 32) % shards_.size();
+}
+
+ShardPool::RouterStripe& ShardPool::stripe_for(uint64_t order_id) {
+    return router_[(order_id * 0x9E3779B97F4A7C15ULL >> 58) % ROUTER_STRIPES];
+}
+
+void ShardPool::remember_order(uint64_t session_id, uint64_t order_id, size_t shard) {
+    RouterStripe& stripe = stripe_for(order_id);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.shards[RouteKey{session_id, order_id}] = shard;
+}
+
+void ShardPool::forget_order(uint64_t session_id, uint64_t order_id) {
+    RouterStripe& stripe = stripe_for(order_id);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.shards.erase(RouteKey{session_id, order_id});
+}
+
+void ShardPool::run_shard(Shard& shard) {
+    utils::place_current_thread("shard-" + std::to_string(shard.index), shard.core, fifo_priority_);
+
+    //Whatever the journal recovered is on the board before the first message
+    for (const auto& [session_id, state] : shard.sessions) {
+        publish_session(shard, session_id, *state);
+    }
+
+    int idle_spins = 0;
+    ShardRequest request;
+    while (running_.load(std::memory_order_relaxed)) {
+        uint32_t doorbell = shard.doorbell.load(std::memory_order_acquire);
+
+        size_t processed = 0;
+        for (size_t p = 0; p < shard.requests.size(); ++p) {
+            for (size_t n = 0; n < BATCH_SIZE && shard.requests[p]->try_pop(request); ++n) {
+                handle_request(shard, p, request);
+                ++processed;
+            }
+        }
+
+        if (processed > 0) {
+            release_responses(shard);
+            notify_producers(shard);
+        }
+
+        //Between batches the State is consistent with everything journaled so far
+        if (shard.snapshot_requested.load(std::memory_order_relaxed) &&
+            !shard.snapshot_in_flight.load(std::memory_order_acquire) && !shard.journal->failed()) {
+            take_snapshot(shard);
+        }
+
+        if (processed > 0) {
+            idle_spins = 0;
+            continue;
+        }
+
+        //Spin for a while to keep latency low under load, then sleep until a producer rings
+        if (++idle_spins < IDLE_SPINS) {
+            utils::cpu_relax();
+            continue;
+        }
+        if (idle_spins == IDLE_SPINS && shard.journal) {
+            shard.journal->sync();
+        }
+        if (busy_poll_) {
+            //Keep spinning, but sync the journal only once per idle stretch
+            idle_spins = IDLE_SPINS;
+            utils::cpu_relax();
+            continue;
+        }
+        shard.doorbell.wait(doorbell, std::memory_order_acquire);
+        idle_spins = 0;
+    }
+}
+
+void ShardPool::handle_request(Shard& shard, size_t producer, const ShardRequest& request) {
+    if (shard.journal && shard.journal->failed()) {
+        reject_unjournaled(shard, producer, request);
+        return;
+    }
+
+    if (request.message_type == ShardRequest::CANCEL_ALL) {
+        cancel_all_orders(shard, request.session_id);
+        if (shard.journal) {
+            shard.journal->append(request.session_id, ShardRequest::CANCEL_ALL, nullptr, 0);
+        }
+        auto it = shard.sessions.find(request.session_id);
+        if (it != shard.sessions.end()) {
+            publish_session(shard, request.session_id, *it->second);
+        }
+        return;
+    }
+
+    State& state = session_state(shard, request.session_id);
+    LatencyStats& latency = LatencyStats::instance();
+    uint64_t start_tsc = TscClock::now();
+    latency.record(request.message_type, LatencyStats::QUEUE, start_tsc - request.submit_tsc);
+
+    switch (request.message_type) {
+        case NewOrder::MESSAGE_TYPE: {
+            const NewOrder& new_order = request.new_order;
+            bool order_accepted = state.add_order_if_accepted(new_order);
+            latency.record(NewOrder::MESSAGE_TYPE, LatencyStats::CHECK, TscClock::now() - start_tsc);
+            if (!order_accepted) {
+                forget_order(request.session_id, new_order.order_id);
+            } else if (shard.journal) {
+                shard.journal->append(request.session_id, new_order);
+            }
+            respond(shard, producer, request, new_order.order_id, order_accepted);
+            if (order_accepted) {
+                publish_position(shard, request.session_id, state, new_order.instrument_id);
+            }
+            log_event(state, order_accepted,
+                      {0, new_order.instrument_id, new_order.order_id, static_cast<int64_t>(new_order.order_qty),
+                       new_order.order_price, {}, NewOrder::MESSAGE_TYPE, new_order.side, false, true});
+            break;
+        }
+        case DeleteOrder::MESSAGE_TYPE: {
+            const DeleteOrder& delete_order = request.delete_order;
+            uint64_t instrument_id = 0;
+            bool order_deleted = state.delete_order(delete_order, instrument_id);
+            latency.record(DeleteOrder::MESSAGE_TYPE, LatencyStats::CHECK, TscClock::now() - start_tsc);
+            if (order_deleted) {
+                forget_order(request.session_id, delete_order.order_id);
+                if (shard.journal) {
+                    shard.journal->append(request.session_id, delete_order);
+                }
+            }
+            respond(shard, producer, request, delete_order.order_id, order_deleted);
+            if (order_deleted) {
+                publish_position(shard, request.session_id, state, instrument_id);
+            }
+            log_event(state, order_deleted,
+                      {0, instrument_id, delete_order.order_id, 0, 0, {}, DeleteOrder::MESSAGE_TYPE, 0, false,
+                       order_deleted});
+            break;
+        }
+        case ModifyOrderQty::MESSAGE_TYPE: {
+            const ModifyOrderQty& modify_order_qty = request.modify_order;
+            uint64_t instrument_id = 0;
+            bool modify_accepted = state.modify_order_if_accepted(modify_order_qty, instrument_id);
+            latency.record(ModifyOrderQty::MESSAGE_TYPE, LatencyStats::CHECK, TscClock::now() - start_tsc);
+            if (modify_accepted && shard.journal) {
+                shard.journal->append(request.session_id, modify_order_qty);
+            }
+            respond(shard, producer, request, modify_order_qty.order_id, modify_accepted);
+            if (modify_accepted) {
+                publish_position(shard, request.session_id, state, instrument_id);
+            }
+            log_event(state, modify_accepted,
+                      {0, instrument_id, modify_order_qty.order_id, static_cast<int64_t>(modify_order_qty.new_qty), 0,
+                       {}, ModifyOrderQty::MESSAGE_TYPE, 0, false, modify_accepted});
+            break;
+        }
+        case Trade::MESSAGE_TYPE: {
+            const Trade& trade = request.trade;
+            state.process_trade(trade);
+            uint64_t end_tsc = TscClock::now();
+            latency.record(Trade::MESSAGE_TYPE, LatencyStats::CHECK, end_tsc - start_tsc);
+            latency.record(Trade::MESSAGE_TYPE, LatencyStats::TOTAL, end_tsc - request.recv_tsc);
+            if (shard.journal) {
+                shard.journal->append(request.session_id, trade);
+            }
+            publish_position(shard, request.session_id, state, trade.instrument_id);
+            log_event(state, true,
+                      {0, trade.instrument_id, trade.trade_id, trade.trade_qty, trade.trade_price, {},
+                       Trade::MESSAGE_TYPE, 0, false, true});
+            break;
+        }
+    }
+}
+
+void ShardPool::reject_unjournaled(Shard& shard, size_t producer, const ShardRequest& request) {
+    switch (request.message_type) {
+        case NewOrder::MESSAGE_TYPE:
+            forget_order(request.session_id, request.new_order.order_id);
+            respond(shard, producer, request, request.new_order.order_id, false);
+            break;
+        case DeleteOrder::MESSAGE_TYPE:
+            respond(shard, producer, request, request.delete_order.order_id, false);
+            break;
+        case ModifyOrderQty::MESSAGE_TYPE:
+            respond(shard, producer, request, request.modify_order.order_id, false);
+            break;
+        default:
+            //Trades and mass cancels get no response
+            break;
+    }
+}
+
+void ShardPool::respond(Shard& shard, size_t producer, const ShardRequest& request, uint64_t order_id, bool accepted) {
+    ShardResponse response{request.connection_id, request.recv_tsc, TscClock::now(), request.message_type,
+                           {OrderResponse::MESSAGE_TYPE, order_id,
+                            accepted ? OrderResponse::Status::ACCEPTED : OrderResponse::Status::REJECTED}};
+
+    //With a journal, responses wait until the batch has been written
+    if (shard.journal) {
+        shard.held_responses.emplace_back(producer, response);
+        return;
+    }
+    push_response(shard, producer, response);
+}
+
+void ShardPool::push_response(Shard& shard, size_t producer, const ShardResponse& response) {
+    shard.responded[producer] = 1;
+
+    //The I/O thread drains its responses while it waits for queue space, so this cannot deadlock
+    while (!shard.responses[producer]->try_push(response)) {
+        notify_producers(shard);
+        shard.responded[producer] = 1;
+        utils::cpu_relax();
+    }
+}
+
+void ShardPool::release_responses(Shard& shard) {
+    if (!shard.journal) {
+        return;
+    }
+
+    //Group commit: one write covers every response of the batch
+    if (!shard.journal->commit()) {
+        //Nothing of the batch is in the journal, so nothing of it may be acknowledged. The
+        //State has already applied it, so the shard stops applying anything and must be
+        //restarted from its journal, which matches what the clients were told.
+        std::cerr << "Shard " << shard.index << ": journal write failed, rejecting " << shard.held_responses.size()
+                  << " responses and every later message until restart\n";
+        for (auto& [producer, response] : shard.held_responses) {
+            response.response.stat = OrderResponse::Status::REJECTED;
+        }
+    }
+    for (auto& [producer, response] : shard.held_responses) {
+        push_response(shard, producer, response);
+    }
+    shard.held_responses.clear();
+}
+
+void ShardPool::notify_producers(Shard& shard) {
+    for (size_t p = 0; p < shard.responded.size(); ++p) {
+        if (!shard.responded[p]) {
+            continue;
+        }
+        shard.responded[p] = 0;
+        if (!producers_[p]->notified.exchange(true)) {
+            if (producers_[p]->doorbell != nullptr) {
+                producers_[p]->doorbell->ring();
+                continue;
+            }
+            uint64_t one = 1;
+            if (write(producers_[p]->response_fd, &one, sizeof(one)) < 0) {
+                std::cerr << "Failed to wake I/O thread!\n";
+            }
+        }
+    }
+}
+
+void ShardPool::take_snapshot(Shard& shard) {
+    shard.snapshot_requested.store(false, std::memory_order_relaxed);
+    SnapshotData& snapshot = shard.snapshot;
+    snapshot.session_count = 0;
+    for (const auto& [session_id, state] : shard.sessions) {
+        if (snapshot.session_count == snapshot.sessions.size()) {
+            snapshot.sessions.emplace_back();
+        }
+        SnapshotSessionData& session = snapshot.sessions[snapshot.session_count++];
+        session.session_id = session_id;
+        state->save_snapshot(session);
+    }
+    shard.snapshot.journal_offset = shard.journal->size();
+    shard.snapshot_in_flight.store(true, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot_queue_.push_back(&shard);
+    }
+    snapshot_cv_.notify_one();
+}
+
+void ShardPool::run_snapshot_writer() {
+    auto next_snapshot = std::chrono::steady_clock::now() + std::chrono::seconds(snapshot_interval_s_);
+    std::vector<Shard*> pending;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(snapshot_mutex_);
+            auto ready = [this] { return snapshot_stop_ || !snapshot_queue_.empty(); };
+            if (snapshot_interval_s_ > 0) {
+                snapshot_cv_.wait_until(lock, next_snapshot, ready);
+            } else {
+                snapshot_cv_.wait(lock, ready);
+            }
+            if (snapshot_stop_) {
+                return;
+            }
+            pending.swap(snapshot_queue_);
+        }
+
+        if (snapshot_interval_s_ > 0 && std::chrono::steady_clock::now() >= next_snapshot) {
+            request_snapshot();
+            next_snapshot += std::chrono::seconds(snapshot_interval_s_);
+        }
+
+        //The shard leaves its shadow copy alone until snapshot_in_flight is cleared
+        for (Shard* shard : pending) {
+            if (write_snapshot(shard_path(shard->index, ".snapshot"), static_cast<uint16_t>(shard->index),
+                               static_cast<uint16_t>(shards_.size()), shard->snapshot)) {
+                std::cout << "Snapshot of shard " << shard->index << " written at journal offset "
+                          << shard->snapshot.journal_offset << "\n";
+            }
+            shard->snapshot_in_flight.store(false, std::memory_order_release);
+        }
+        pending.clear();
+    }
+}
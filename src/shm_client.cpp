@@ -0,0 +1,140 @@
+//shm_client.cpp
+//
+//This file implements ShmClient, the shared-memory gateway client for the RiskServer.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "shm_client.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+#include "utils.h"
+
+namespace {
+
+//How long a futex wait sleeps, or roughly how many spins pass, before checking that the server is still running
+constexpr int WAIT_TIMEOUT_MS = 100;
+constexpr int LIVENESS_SPINS = 1 << 20;
+
+}
+
+ShmClient::ShmClient(const std::string& name, ShmWait wait) : name_(name), wait_(wait) {}
+
+ShmClient::~ShmClient() {
+    disconnect();
+}
+
+bool ShmClient::connect_to_server() {
+    if (!segment_.open(name_)) {
+        return false;
+    }
+
+    ShmGatewayLayout& layout = *segment_.layout();
+    uint32_t expected = ShmGatewayLayout::FREE;
+    if (!layout.state.compare_exchange_strong(expected, ShmGatewayLayout::ATTACHED)) {
+        std::cerr << "Shared memory segment " << name_ << " is in use by another gateway!\n";
+        return false;
+    }
+    layout.client_pid.store(getpid(), std::memory_order_release);
+    layout.requests.doorbell().ring();
+    connected_ = true;
+    return true;
+}
+
+void ShmClient::disconnect() {
+    if (!connected_) {
+        return;
+    }
+    connected_ = false;
+
+    //Published after the last request, so the server processes them all before closing
+    ShmGatewayLayout& layout = *segment_.layout();
+    layout.state.store(ShmGatewayLayout::CLOSING, std::memory_order_release);
+    layout.requests.doorbell().ring();
+}
+
+bool ShmClient::send_message(const char* message, size_t size) {
+    if (!connected_) {
+        std::cerr << "No connection to server!\n";
+        return false;
+    }
+
+    //One frame per slot, as the server expects
+    ShmRing& requests = segment_.layout()->requests;
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < sizeof(Header)) {
+            std::cerr << "Incomplete message header!\n";
+            return false;
+        }
+        Header header;
+        memcpy(&header, message + offset, sizeof(Header));
+        size_t frame_size = sizeof(Header) + header.payload_size;
+        if (frame_size > size - offset || frame_size > ShmRing::SLOT_DATA) {
+            std::cerr << "Message does not fit a shared memory slot!\n";
+            return false;
+        }
+        while (!requests.try_push(message + offset, frame_size)) {
+            utils::cpu_relax();
+        }
+        offset += frame_size;
+    }
+    requests.doorbell().ring();
+    return true;
+}
+
+bool ShmClient::receive_response(char* buffer, size_t size) {
+    if (!connected_) {
+        std::cerr << "No connection to server!\n";
+        return false;
+    }
+
+    ShmRing& responses = segment_.layout()->responses;
+    const ShmRing::Slot* slot;
+    int spins = 0;
+    while ((slot = responses.front()) == nullptr) {
+        if (wait_ == ShmWait::FUTEX) {
+            responses.doorbell().wait([&responses] { return !responses.empty(); }, WAIT_TIMEOUT_MS);
+        } else if (++spins < LIVENESS_SPINS) {
+            utils::cpu_relax();
+            continue;
+        }
+        spins = 0;
+        if (responses.empty() && !server_running()) {
+            std::cerr << "Server on " << name_ << " has exited!\n";
+            connected_ = false;
+            return false;
+        }
+    }
+    memcpy(buffer, slot->data, std::min<size_t>(size, slot->size));
+    responses.pop();
+    return true;
+}
+
+ssize_t ShmClient::receive_some(char* buffer, size_t size) {
+    if (!connected_) {
+        return -1;
+    }
+
+    ShmRing& responses = segment_.layout()->responses;
+    size_t copied = 0;
+    const ShmRing::Slot* slot;
+    while ((slot = responses.front()) != nullptr && copied + slot->size <= size) {
+        memcpy(buffer + copied, slot->data, slot->size);
+        copied += slot->size;
+        responses.pop();
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+bool ShmClient::server_running() const {
+    //A killed server leaves its segment behind, so ask after the process itself
+    pid_t pid = segment_.layout()->server_pid;
+    return !(kill(pid, 0) < 0 && errno == ESRCH);
+}
@@ -0,0 +1,175 @@
+//shm_ring.cpp
+//
+//This file implements the shared-memory rings, their futex doorbell and the
+//mapping of gateway segments.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "shm_ring.h"
+
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/futex.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+//Not FUTEX_PRIVATE_FLAG: the waiter and the waker are usually different processes
+long futex(std::atomic<uint32_t>* word, int operation, uint32_t value, const timespec* timeout) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), operation, value, timeout, nullptr, 0);
+}
+
+std::string shm_path(const std::string& name) {
+    return name.front() == '/' ? name : "/" + name;
+}
+
+}
+
+bool parse_shm_wait(const char* text, ShmWait& wait) {
+    if (std::strcmp(text, "spin") == 0) {
+        wait = ShmWait::SPIN;
+    } else if (std::strcmp(text, "futex") == 0) {
+        wait = ShmWait::FUTEX;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void FutexDoorbell::ring() {
+    //Orders the caller's publication before the sleeper check, pairing with wait()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    sequence.fetch_add(1, std::memory_order_seq_cst);
+    futex(&sequence, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+void FutexDoorbell::sleep(uint32_t seen, int timeout_ms) {
+    timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1'000'000L};
+    //Returns at once if the sequence moved since `seen`
+    futex(&sequence, FUTEX_WAIT, seen, &timeout);
+}
+
+bool ShmRing::try_push(const char* data, size_t size) {
+    if (size > SLOT_DATA) {
+        return false;
+    }
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ >= SLOT_COUNT) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ >= SLOT_COUNT) {
+            return false;
+        }
+    }
+    Slot& slot = slots_[tail % SLOT_COUNT];
+    slot.size = static_cast<uint32_t>(size);
+    memcpy(slot.data, data, size);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+const ShmRing::Slot* ShmRing::front() {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_) {
+            return nullptr;
+        }
+    }
+    return &slots_[head % SLOT_COUNT];
+}
+
+void ShmRing::pop() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void ShmRing::reset() {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    cached_head_ = 0;
+    cached_tail_ = 0;
+}
+
+ShmSegment::~ShmSegment() {
+    if (layout_ != nullptr) {
+        munmap(layout_, sizeof(ShmGatewayLayout));
+    }
+    if (owner_) {
+        shm_unlink(shm_path(name_).c_str());
+    }
+}
+
+bool ShmSegment::create(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    name_ = name;
+    std::string path = shm_path(name);
+
+    //A segment left by a server that died still has its old gateway's state
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "Can't create shared memory segment " << path << "\n";
+        return false;
+    }
+    owner_ = true;
+    if (ftruncate(fd, sizeof(ShmGatewayLayout)) < 0) {
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(ShmGatewayLayout), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    layout_ = new (memory) ShmGatewayLayout{};
+    layout_->magic = ShmGatewayLayout::MAGIC;
+    layout_->version = ShmGatewayLayout::VERSION;
+    layout_->server_pid = getpid();
+    layout_->state.store(ShmGatewayLayout::FREE, std::memory_order_release);
+    return true;
+}
+
+bool ShmSegment::open(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    name_ = name;
+    std::string path = shm_path(name);
+
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "Can't open shared memory segment " << path << "\n";
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) != sizeof(ShmGatewayLayout)) {
+        std::cerr << "Shared memory segment " << path << " has the wrong size\n";
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(ShmGatewayLayout), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    layout_ = static_cast<ShmGatewayLayout*>(memory);
+    if (layout_->magic != ShmGatewayLayout::MAGIC || layout_->version != ShmGatewayLayout::VERSION) {
+        std::cerr << "Shared memory segment " << path << " is not a RiskServer gateway\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,179 @@
+//snapshot.cpp
+//
+//This file implements writing and memory-mapped reading of State snapshots.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "snapshot.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+//FNV-1a over a byte range, continuing from hash
+uint64_t checksum(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+constexpr uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+
+bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+}
+
+bool write_snapshot(const std::string& path, uint16_t shard, uint16_t shard_count, const SnapshotData& snapshot) {
+    //Lay the sections out in memory first, so the checksum and size go in the header
+    std::vector<char> body;
+    auto append = [&body](const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        body.insert(body.end(), bytes, bytes + size);
+    };
+    for (size_t i = 0; i < snapshot.session_count; ++i) {
+        const SnapshotSessionData& session = snapshot.sessions[i];
+        SnapshotSession section{session.session_id, session.max_buy_position, session.max_sell_position,
+                                session.instruments.size(), session.orders.size()};
+        append(&section, sizeof(section));
+        append(session.instruments.data(), session.instruments.size() * sizeof(SnapshotInstrument));
+        append(session.orders.data(), session.orders.size() * sizeof(SnapshotOrder));
+    }
+
+    SnapshotFileHeader header{};
+    header.magic = SnapshotFileHeader::MAGIC;
+    header.version = SnapshotFileHeader::VERSION;
+    header.shard = shard;
+    header.shard_count = shard_count;
+    header.journal_offset = snapshot.journal_offset;
+    header.session_count = snapshot.session_count;
+    header.body_size = body.size();
+    header.checksum = checksum(CHECKSUM_SEED, body.data(), body.size());
+
+    std::string temp_path = path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create snapshot " << temp_path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    bool ok = write_all(fd, &header, sizeof(header)) && write_all(fd, body.data(), body.size()) &&
+              fdatasync(fd) == 0;
+    close(fd);
+    if (!ok || rename(temp_path.c_str(), path.c_str()) < 0) {
+        std::cerr << "Failed to write snapshot " << path << ": " << strerror(errno) << "\n";
+        unlink(temp_path.c_str());
+        return false;
+    }
+
+    //Make the rename itself durable
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    int directory_fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory_fd >= 0) {
+        fsync(directory_fd);
+        close(directory_fd);
+    }
+    return true;
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        std::cerr << "Failed to open snapshot " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotFileHeader)) {
+        std::cerr << "Snapshot " << path << " is truncated!\n";
+        close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map snapshot " << path << ": " << strerror(errno) << "\n";
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const char*>(data);
+
+    const SnapshotFileHeader* header = reinterpret_cast<const SnapshotFileHeader*>(data_);
+    if (header->magic != SnapshotFileHeader::MAGIC || header->version != SnapshotFileHeader::VERSION) {
+        std::cerr << "Snapshot " << path << " has an unknown format!\n";
+        return false;
+    }
+    if (sizeof(SnapshotFileHeader) + header->body_size != size_) {
+        std::cerr << "Snapshot " << path << " is truncated!\n";
+        return false;
+    }
+    if (checksum(CHECKSUM_SEED, data_ + sizeof(SnapshotFileHeader), header->body_size) != header->checksum) {
+        std::cerr << "Snapshot " << path << " is corrupt!\n";
+        return false;
+    }
+
+    //Check every section fits, so next_session can trust the counts
+    size_t offset = sizeof(SnapshotFileHeader);
+    for (uint64_t i = 0; i < header->session_count; ++i) {
+        if (offset + sizeof(SnapshotSession) > size_) {
+            std::cerr << "Snapshot " << path << " is truncated!\n";
+            return false;
+        }
+        const SnapshotSession* session = reinterpret_cast<const SnapshotSession*>(data_ + offset);
+        offset += sizeof(SnapshotSession) + session->instrument_count * sizeof(SnapshotInstrument) +
+                  session->order_count * sizeof(SnapshotOrder);
+        if (offset > size_) {
+            std::cerr << "Snapshot " << path << " is truncated!\n";
+            return false;
+        }
+    }
+
+    header_ = header;
+    offset_ = sizeof(SnapshotFileHeader);
+    return true;
+}
+
+bool SnapshotReader::next_session(const SnapshotSession*& session, const SnapshotInstrument*& instruments,
+                                  const SnapshotOrder*& orders) {
+    if (header_ == nullptr || offset_ >= size_) {
+        return false;
+    }
+    session = reinterpret_cast<const SnapshotSession*>(data_ + offset_);
+    instruments = reinterpret_cast<const SnapshotInstrument*>(data_ + offset_ + sizeof(SnapshotSession));
+    orders = reinterpret_cast<const SnapshotOrder*>(instruments + session->instrument_count);
+    offset_ = reinterpret_cast<const char*>(orders + session->order_count) - data_;
+    return true;
+}
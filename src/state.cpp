@@ -9,154 +9,279 @@
 
 #include "state.h"
 
-#include <algorithm> //For std::find_if
+#include <algorithm> //For std::max
 #include <iostream>  //For printing state in tests
 
-bool State::add_order_if_accepted(const NewOrder& order) {
-    int64_t buy_side, sell_side;
-    if (simulate_add_order(order, buy_side, sell_side)) {
-        auto& instrument_state = instrument_states_[order.instrument_id];
-        instrument_state.orders.push_back({order.order_id, order.order_qty, order.side});
-        if (order.side == 'B') {
-            instrument_state.buy_qty += order.order_qty;
-        } else if (order.side == 'S') {
-            instrument_state.sell_qty += order.order_qty;
+//The order index is sized at twice the pool
+static_assert(OrderPool::MAX_CAPACITY <= SIZE_MAX / 2, "The order index size overflows size_t");
+
+template <typename Checks>
+BasicState<Checks>::BasicState(const RiskLimits& limits, size_t max_orders, AccountExposure* account)
+    : LIMITS(limits),
+      orders_(max_orders),
+      order_index_(orders_.capacity() * 2),
+      account_(limits.max_account_position == 0 && limits.max_account_notional == 0 ? nullptr
+               : account != nullptr                                                 ? account
+                                                                                    : &own_account_) {}
+
+template <typename Checks>
+BasicState<Checks>::BasicState(int64_t buy_threshold, int64_t sell_threshold, size_t max_orders)
+    : BasicState(RiskLimits{buy_threshold, sell_threshold}, max_orders) {}
+
+template <typename Checks>
+BasicState<Checks>::~BasicState() {
+    add_exposure(-exposure_position_, -exposure_notional_);
+}
+
+template <typename Checks>
+bool BasicState<Checks>::add_order_if_accepted(const NewOrder& order) {
+    //An order ID can only rest once, otherwise it could not be deleted or modified reliably
+    if (order_index_.count(order.order_id) != 0) {
+        return false;
+    }
+
+    //Creates the instrument state if it doesn't exist, even when the order is rejected
+    auto& instrument_state = instrument_states_[order.instrument_id];
+
+    int64_t buy_qty = instrument_state.buy_qty + (order.side == 'B' ? order.order_qty : 0);
+    int64_t sell_qty = instrument_state.sell_qty + (order.side == 'S' ? order.order_qty : 0);
+    if (!passes_checks(instrument_state, order.side, order.order_qty, order.order_price, buy_qty, sell_qty)) {
+        return false;
+    }
+
+    int64_t position_delta = 0;
+    int64_t notional_delta = 0;
+    if (account_ != nullptr) {
+        int64_t net_position = instrument_state.net_position;
+        position_delta = worst_position(net_position, buy_qty, sell_qty) -
+                         worst_position(net_position, instrument_state.buy_qty, instrument_state.sell_qty);
+        notional_delta = order_notional(order.order_qty, order.order_price);
+        if (!try_add_exposure(position_delta, notional_delta)) {
+            return false;
         }
-        return true;
     }
 
-    //Add the instrument state if it doesn't exist to avoid out_of_range errors
-    if (instrument_states_.find(order.instrument_id) == instrument_states_.end()) {
-        instrument_states_[order.instrument_id] = InstrumentState();
+    //A full pool rejects the order rather than allocating
+    uint32_t node = orders_.allocate();
+    if (node == OrderPool::NONE) {
+        add_exposure(-position_delta, -notional_delta);
+        return false;
     }
-    return false;
+    OrderPool::Node& resting = orders_[node];
+    resting.order_id = order.order_id;
+    resting.instrument_id = order.instrument_id;
+    resting.order_qty = order.order_qty;
+    resting.order_price = order.order_price;
+    resting.side = order.side;
+    orders_.link_front(instrument_state.orders, node);
+    ++instrument_state.order_count;
+    order_index_[order.order_id] = node;
+
+    instrument_state.buy_qty = buy_qty;
+    instrument_state.sell_qty = sell_qty;
+    return true;
 }
 
-std::optional<uint64_t> State::find_instrument_id_by_order(uint64_t order_id) const {
-    for (const auto& [instrument_id, state] : instrument_states_) {
-        for (const auto& order : state.orders) {
-            if (order.order_id == order_id) {
-                return instrument_id;
-            }
-        }
+template <typename Checks>
+std::optional<uint64_t> BasicState<Checks>::find_instrument_id_by_order(uint64_t order_id) const {
+    auto it = order_index_.find(order_id);
+    if (it == order_index_.end()) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    return orders_[it->second].instrument_id;
 }
 
-bool State::delete_order(const DeleteOrder& order) {
-    for (auto& [instrument_id, state] : instrument_states_) {
-        auto it = find_order(state, order.order_id);
-        if (it != state.orders.end()) {
-            if (it->side == 'B') {
-                state.buy_qty -= it->order_qty;
-            } else if (it->side == 'S') {
-                state.sell_qty -= it->order_qty;
-            }
-            state.orders.erase(it);
-            return true;
-        }
+template <typename Checks>
+bool BasicState<Checks>::delete_order(const DeleteOrder& order) {
+    uint64_t instrument_id;
+    return delete_order(order, instrument_id);
+}
+
+template <typename Checks>
+bool BasicState<Checks>::delete_order(const DeleteOrder& order, uint64_t& instrument_id) {
+    auto location = order_index_.find(order.order_id);
+    if (location == order_index_.end()) {
+        return false;
+    }
+
+    uint32_t node = location->second;
+    const OrderPool::Node& resting = orders_[node];
+    instrument_id = resting.instrument_id;
+    auto& state = instrument_states_.at(instrument_id);
+    int64_t worst_before = worst_position(state.net_position, state.buy_qty, state.sell_qty);
+    if (resting.side == 'B') {
+        state.buy_qty -= resting.order_qty;
+    } else if (resting.side == 'S') {
+        state.sell_qty -= resting.order_qty;
     }
-    return false;
+    if (account_ != nullptr) {
+        add_exposure(worst_position(state.net_position, state.buy_qty, state.sell_qty) - worst_before,
+                     -order_notional(resting.order_qty, resting.order_price));
+    }
+    remove_order(state, node);
+    return true;
 }
 
-bool State::modify_order_if_accepted(const ModifyOrderQty& order) {
-    for (auto& [instrument_id, state] : instrument_states_) {
-        auto it = find_order(state, order.order_id);
-        if (it != state.orders.end()) {
-            int64_t original_qty = it->order_qty;
-            int64_t new_qty = order.new_qty;
-            char side = it->side;
-
-            //Temporarily update the buy/sell quantities
-            if (side == 'B') {
-                state.buy_qty = state.buy_qty - original_qty + new_qty;
-            } else if (side == 'S') {
-                state.sell_qty = state.sell_qty - original_qty + new_qty;
-            }
-
-            //Calculate hypothetical worst positions
-            int64_t buy_side = calculate_hypothetical_worst_buy_position(instrument_id);
-            int64_t sell_side = calculate_hypothetical_worst_sell_position(instrument_id);
-
-            //Check thresholds
-            if ((side == 'B' && buy_side > BUY_THRESHOLD) || 
-                (side == 'S' && sell_side > SELL_THRESHOLD)) {
-                //Revert the changes if thresholds are exceeded
-                if (side == 'B') {
-                    state.buy_qty = state.buy_qty + original_qty - new_qty;
-                } else if (side == 'S') {
-                    state.sell_qty = state.sell_qty + original_qty - new_qty;
-                }
-                return false;
-            }
-
-            //Apply the modification
-            it->order_qty = new_qty;
-            return true;
+template <typename Checks>
+bool BasicState<Checks>::modify_order_if_accepted(const ModifyOrderQty& order) {
+    uint64_t instrument_id;
+    return modify_order_if_accepted(order, instrument_id);
+}
+
+template <typename Checks>
+bool BasicState<Checks>::modify_order_if_accepted(const ModifyOrderQty& order, uint64_t& instrument_id) {
+    auto location = order_index_.find(order.order_id);
+    if (location == order_index_.end()) {
+        return false;
+    }
+
+    OrderPool::Node& resting = orders_[location->second];
+    instrument_id = resting.instrument_id;
+    auto& state = instrument_states_.at(instrument_id);
+    int64_t original_qty = resting.order_qty;
+    int64_t new_qty = order.new_qty;
+    char side = resting.side;
+
+    //Check the quantities the modification would leave behind, without touching the state
+    int64_t buy_qty = state.buy_qty;
+    int64_t sell_qty = state.sell_qty;
+    if (side == 'B') {
+        buy_qty = buy_qty - original_qty + new_qty;
+    } else if (side == 'S') {
+        sell_qty = sell_qty - original_qty + new_qty;
+    }
+
+    if (!passes_checks(state, side, new_qty, resting.order_price, buy_qty, sell_qty)) {
+        return false;
+    }
+
+    if (account_ != nullptr) {
+        int64_t position_delta = worst_position(state.net_position, buy_qty, sell_qty) -
+                                 worst_position(state.net_position, state.buy_qty, state.sell_qty);
+        int64_t notional_delta = order_notional(new_qty, resting.order_price) -
+                                 order_notional(original_qty, resting.order_price);
+        if (!try_add_exposure(position_delta, notional_delta)) {
+            return false;
         }
     }
-    return false;
+
+    //Apply the modification
+    state.buy_qty = buy_qty;
+    state.sell_qty = sell_qty;
+    resting.order_qty = new_qty;
+    return true;
 }
 
-void State::process_trade(const Trade& trade) {
+template <typename Checks>
+void BasicState<Checks>::process_trade(const Trade& trade) {
     auto& instrument_state = instrument_states_[trade.instrument_id];
+    int64_t worst_before = worst_position(instrument_state.net_position, instrument_state.buy_qty,
+                                          instrument_state.sell_qty);
     instrument_state.net_position += trade.trade_qty;
+    if (account_ != nullptr) {
+        add_exposure(worst_position(instrument_state.net_position, instrument_state.buy_qty,
+                                    instrument_state.sell_qty) - worst_before,
+                     0);
+    }
+    if (trade.trade_price != 0) {
+        instrument_state.last_trade_price = trade.trade_price;
+    }
 }
 
-int64_t State::calculate_hypothetical_worst_buy_position(uint64_t instrument_id) const {
+template <typename Checks>
+int64_t BasicState<Checks>::calculate_hypothetical_worst_buy_position(uint64_t instrument_id) const {
     const auto& state = instrument_states_.at(instrument_id);
     return std::max(state.buy_qty, state.net_position + state.buy_qty);
 }
 
-int64_t State::calculate_hypothetical_worst_sell_position(uint64_t instrument_id) const {
+template <typename Checks>
+int64_t BasicState<Checks>::calculate_hypothetical_worst_sell_position(uint64_t instrument_id) const {
     const auto& state = instrument_states_.at(instrument_id);
     return std::max(state.sell_qty, state.sell_qty - state.net_position);
 }
 
-bool State::simulate_add_order(const NewOrder& order, int64_t& buy_side, int64_t& sell_side) const {
-    auto it = instrument_states_.find(order.instrument_id);
-    if (it == instrument_states_.end()) {
-        //Create a default InstrumentState if it does not exist
-        InstrumentState instrument_state;
-        if (order.side == 'B') {
-            instrument_state.buy_qty += order.order_qty;
-        } else if (order.side == 'S') {
-            instrument_state.sell_qty += order.order_qty;
-        }
+template <typename Checks>
+bool BasicState<Checks>::passes_checks(const InstrumentState& state, char side, uint64_t order_qty,
+                                       uint64_t order_price, int64_t buy_qty, int64_t sell_qty) const {
+    RiskCheckInput input{side, order_qty, order_price, state.net_position, buy_qty, sell_qty, state.last_trade_price};
+    return Checks::passes(LIMITS, input);
+}
 
-        buy_side = std::max(instrument_state.buy_qty, instrument_state.net_position + instrument_state.buy_qty);
-        sell_side = std::max(instrument_state.sell_qty, instrument_state.sell_qty - instrument_state.net_position);
+template <typename Checks>
+int64_t BasicState<Checks>::order_notional(uint64_t order_qty, uint64_t order_price) const {
+    int64_t notional;
+    if (LIMITS.max_account_notional == 0) {
+        return 0;
+    }
+    return __builtin_mul_overflow(order_qty, order_price, &notional) ? INT64_MAX : notional;
+}
 
-        if ((order.side == 'B' && buy_side > BUY_THRESHOLD) || 
-            (order.side == 'S' && sell_side > SELL_THRESHOLD)) {
-            return false;
-        }
-        return true;
-    } else {
-        InstrumentState instrument_state = it->second;
-        if (order.side == 'B') {
-            instrument_state.buy_qty += order.order_qty;
-        } else if (order.side == 'S') {
-            instrument_state.sell_qty += order.order_qty;
-        }
+template <typename Checks>
+bool BasicState<Checks>::try_add_exposure(int64_t position_delta, int64_t notional_delta) {
+    if (!account_->try_add(position_delta, notional_delta, LIMITS.max_account_position, LIMITS.max_account_notional)) {
+        return false;
+    }
+    exposure_position_ += position_delta;
+    exposure_notional_ += notional_delta;
+    return true;
+}
 
-        buy_side = std::max(instrument_state.buy_qty, instrument_state.net_position + instrument_state.buy_qty);
-        sell_side = std::max(instrument_state.sell_qty, instrument_state.sell_qty - instrument_state.net_position);
+template <typename Checks>
+void BasicState<Checks>::add_exposure(int64_t position_delta, int64_t notional_delta) {
+    if (account_ == nullptr) {
+        return;
+    }
+    account_->add(position_delta, notional_delta);
+    exposure_position_ += position_delta;
+    exposure_notional_ += notional_delta;
+}
 
-        if ((order.side == 'B' && buy_side > BUY_THRESHOLD) || 
-            (order.side == 'S' && sell_side > SELL_THRESHOLD)) {
-            return false;
+template <typename Checks>
+void BasicState<Checks>::rebuild_exposure() {
+    if (account_ == nullptr) {
+        return;
+    }
+    int64_t position = 0;
+    int64_t notional = 0;
+    for (const auto& [instrument_id, state] : instrument_states_) {
+        position += worst_position(state.net_position, state.buy_qty, state.sell_qty);
+        for (uint32_t node = state.orders; node != OrderPool::NONE; node = orders_[node].next) {
+            notional += order_notional(orders_[node].order_qty, orders_[node].order_price);
         }
-        return true;
     }
+    add_exposure(position - exposure_position_, notional - exposure_notional_);
 }
 
-std::vector<State::Order>::iterator State::find_order(InstrumentState& state, uint64_t order_id) {
-    return std::find_if(state.orders.begin(), state.orders.end(),
-                        [order_id](const Order& order) { return order.order_id == order_id; });
+template <typename Checks>
+void BasicState<Checks>::suspend_account_limits() {
+    if (account_ == nullptr) {
+        return;
+    }
+    add_exposure(-exposure_position_, -exposure_notional_);
+    suspended_account_ = account_;
+    account_ = nullptr;
 }
 
-void State::print_instrument_state(uint64_t instrument_id) const {
+template <typename Checks>
+void BasicState<Checks>::resume_account_limits() {
+    if (suspended_account_ == nullptr) {
+        return;
+    }
+    account_ = suspended_account_;
+    suspended_account_ = nullptr;
+    rebuild_exposure();
+}
+
+template <typename Checks>
+void BasicState<Checks>::remove_order(InstrumentState& state, uint32_t node) {
+    order_index_.erase(orders_[node].order_id);
+    orders_.unlink(state.orders, node);
+    --state.order_count;
+    orders_.release(node);
+}
+
+template <typename Checks>
+void BasicState<Checks>::print_instrument_state(uint64_t instrument_id) const {
     auto it = instrument_states_.find(instrument_id);
     if (it == instrument_states_.end()) {
         std::cout << "Instrument ID: " << instrument_id << " not found.\n";
@@ -175,6 +300,96 @@ void State::print_instrument_state(uint64_t instrument_id) const {
     std::cout << "Hypothetical Worst Sell Position: " << sell_side << "\n\n";
 }
 
-void State::reset() {
+template <typename Checks>
+bool BasicState<Checks>::get_position(uint64_t instrument_id, Position& position) const {
+    auto it = instrument_states_.find(instrument_id);
+    if (it == instrument_states_.end()) {
+        return false;
+    }
+    position = {it->second.net_position, it->second.buy_qty, it->second.sell_qty};
+    return true;
+}
+
+template <typename Checks>
+void BasicState<Checks>::reset() {
+    add_exposure(-exposure_position_, -exposure_notional_);
     instrument_states_.clear();
+    order_index_.clear();
+    orders_.reset();
+}
+
+template <typename Checks>
+void BasicState<Checks>::cancel_all_orders(std::vector<uint64_t>& cancelled) {
+    for (auto& [instrument_id, state] : instrument_states_) {
+        for (uint32_t node = state.orders; node != OrderPool::NONE; node = orders_[node].next) {
+            cancelled.push_back(orders_[node].order_id);
+        }
+        state.buy_qty = 0;
+        state.sell_qty = 0;
+        state.orders = OrderPool::NONE;
+        state.order_count = 0;
+    }
+    order_index_.clear();
+    orders_.reset();
+    rebuild_exposure();
 }
+
+template <typename Checks>
+void BasicState<Checks>::save_snapshot(SnapshotSessionData& snapshot) const {
+    snapshot.max_buy_position = LIMITS.max_buy_position;
+    snapshot.max_sell_position = LIMITS.max_sell_position;
+    snapshot.instruments.clear();
+    snapshot.orders.clear();
+    snapshot.orders.reserve(orders_.in_use());
+
+    for (const auto& [instrument_id, state] : instrument_states_) {
+        snapshot.instruments.push_back(
+            {instrument_id, state.net_position, state.buy_qty, state.sell_qty, state.last_trade_price});
+
+        size_t first = snapshot.orders.size();
+        for (uint32_t node = state.orders; node != OrderPool::NONE; node = orders_[node].next) {
+            const OrderPool::Node& resting = orders_[node];
+            snapshot.orders.push_back({resting.order_id, resting.instrument_id, resting.order_qty,
+                                       resting.order_price, resting.side, {}});
+        }
+        //Loading links every order at the front, so store each list oldest first
+        std::reverse(snapshot.orders.begin() + first, snapshot.orders.end());
+    }
+}
+
+template <typename Checks>
+bool BasicState<Checks>::load_snapshot(const SnapshotInstrument* instruments, size_t instrument_count,
+                          const SnapshotOrder* orders, size_t order_count) {
+    reset();
+    for (size_t i = 0; i < instrument_count; ++i) {
+        auto& state = instrument_states_[instruments[i].instrument_id];
+        state.net_position = instruments[i].net_position;
+        state.buy_qty = instruments[i].buy_qty;
+        state.sell_qty = instruments[i].sell_qty;
+        state.last_trade_price = instruments[i].last_trade_price;
+    }
+
+    for (size_t i = 0; i < order_count; ++i) {
+        const SnapshotOrder& order = orders[i];
+        uint32_t node = orders_.allocate();
+        if (node == OrderPool::NONE) {
+            rebuild_exposure();
+            return false;
+        }
+        OrderPool::Node& resting = orders_[node];
+        resting.order_id = order.order_id;
+        resting.instrument_id = order.instrument_id;
+        resting.order_qty = order.order_qty;
+        resting.order_price = order.order_price;
+        resting.side = order.side;
+        auto& state = instrument_states_[order.instrument_id];
+        orders_.link_front(state.orders, node);
+        ++state.order_count;
+        order_index_[order.order_id] = node;
+    }
+    rebuild_exposure();
+    return true;
+}
+
+template class BasicState<DefaultRiskChecks>;
+template class BasicState<PositionRiskChecks>;
@@ -0,0 +1,108 @@
+//trade_feed.cpp
+//
+//This file implements the UDP socket side of TradeFeed.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "trade_feed.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <iostream>
+#include <netinet/in.h>
+#include <unistd.h>
+
+namespace {
+
+//Room for bursts that arrive while the event loop is busy; the kernel caps it at rmem_max
+constexpr int RECEIVE_BUFFER = 4 * 1024 * 1024;
+
+}
+
+TradeFeed::TradeFeed(size_t window)
+    : tracker_(window), buffers_(BATCH * MAX_DATAGRAM), headers_(BATCH), vectors_(BATCH) {
+    for (size_t i = 0; i < BATCH; ++i) {
+        vectors_[i].iov_base = buffers_.data() + i * MAX_DATAGRAM;
+        vectors_[i].iov_len = MAX_DATAGRAM;
+        headers_[i].msg_hdr.msg_iov = &vectors_[i];
+        headers_[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+TradeFeed::~TradeFeed() {
+    if (socket_ != -1) {
+        close(socket_);
+    }
+}
+
+bool TradeFeed::open(const std::string& address, int port, const std::string& interface) {
+    in_addr group{};
+    if (inet_pton(AF_INET, address.c_str(), &group) != 1) {
+        std::cerr << "Invalid trade feed address: " << address << "\n";
+        return false;
+    }
+    bool multicast = IN_MULTICAST(ntohl(group.s_addr));
+
+    socket_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket_ < 0) {
+        std::cerr << "Can't create the trade feed socket!\n";
+        return false;
+    }
+
+    //Lets several risk instances on one host join the same multicast feed, each getting
+    //a copy of every datagram. A unicast port shared this way would split the datagrams
+    //between the instances instead, so there each instance needs a port of its own.
+    if (multicast) {
+        int one = 1;
+        if (setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+            setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+            std::cerr << "Can't share the trade feed port " << port << "\n";
+            return false;
+        }
+    }
+    int receive_buffer = RECEIVE_BUFFER;
+    if (setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer)) < 0) {
+        std::cerr << "Can't size the trade feed receive buffer!\n";
+        return false;
+    }
+
+    //Binding to the group keeps datagrams for other groups on the same port out
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr = group;
+    addr.sin_port = htons(port);
+    if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Can't bind the trade feed to " << address << ":" << port << "\n";
+        return false;
+    }
+
+    if (multicast) {
+        ip_mreq membership{};
+        membership.imr_multiaddr = group;
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (!interface.empty() && inet_pton(AF_INET, interface.c_str(), &membership.imr_interface) != 1) {
+            std::cerr << "Invalid trade feed interface: " << interface << "\n";
+            return false;
+        }
+        if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+            std::cerr << "Can't join multicast group " << address << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int TradeFeed::read_batch() {
+    while (true) {
+        int count = recvmmsg(socket_, headers_.data(), BATCH, MSG_DONTWAIT, nullptr);
+        ++syscalls_;
+        if (count >= 0) {
+            return count;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+}
@@ -0,0 +1,236 @@
+//uring.cpp
+//
+//This file implements the IoUring wrapper on top of the raw io_uring system calls.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+//The only provided buffer group a ring registers
+constexpr uint16_t BUFFER_GROUP = 0;
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+}
+
+IoUring::~IoUring() {
+    if (buffers_ != nullptr) {
+        munmap(buffers_, static_cast<size_t>(buffer_count_) * buffer_size_);
+    }
+    if (buffer_ring_ != nullptr) {
+        munmap(buffer_ring_, buffer_ring_size_);
+    }
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ != -1) {
+        close(ring_fd_);
+    }
+}
+
+bool IoUring::init(unsigned entries, unsigned buffer_count, unsigned buffer_size) {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_R_DISABLED |
+                   IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4; //Multishot operations complete many times per submission
+    ring_fd_ = io_uring_setup(entries, &params);
+    if (ring_fd_ < 0) {
+        ring_fd_ = -1;
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+        cq_ring_ = nullptr;
+        return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+
+    //Slot i of the index array always points at SQE i
+    unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; ++i) {
+        sq_array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    //Provided buffers: the ring of descriptors and the memory they point into
+    buffer_count_ = buffer_count;
+    buffer_size_ = buffer_size;
+    buffer_ring_size_ = buffer_count * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* buffers = mmap(nullptr, static_cast<size_t>(buffer_count) * buffer_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED || buffers == MAP_FAILED) {
+        return false;
+    }
+    buffer_ring_ = static_cast<io_uring_buf_ring*>(ring);
+    buffers_ = static_cast<char*>(buffers);
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<uint64_t>(buffer_ring_);
+    registration.ring_entries = buffer_count;
+    registration.bgid = BUFFER_GROUP;
+    if (io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        return false;
+    }
+    for (unsigned i = 0; i < buffer_count; ++i) {
+        recycle_buffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+bool IoUring::enable() {
+    return io_uring_register(ring_fd_, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) == 0;
+}
+
+void IoUring::recycle_buffer(uint16_t id) {
+    //The descriptors start at the ring itself, their first slot overlapping the tail. Not
+    //through bufs[]: in C++ the header's flexible array wrapper moves it to offset 8.
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(buffer_ring_)[buffer_tail_ & (buffer_count_ - 1)];
+    entry.addr = reinterpret_cast<uint64_t>(buffer(id));
+    entry.len = buffer_size_;
+    entry.bid = id;
+    ++buffer_tail_;
+    __atomic_store_n(&buffer_ring_->tail, buffer_tail_, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    //Full: hand the queued entries to the kernel to make room
+    while (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+        enter(to_submit_, 0, 0);
+    }
+    io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    ++sq_local_tail_;
+    ++to_submit_;
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+void IoUring::prep_multishot_accept(int fd, uint64_t user_data) {
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = user_data;
+}
+
+void IoUring::prep_multishot_recv(int fd, uint64_t user_data) {
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = user_data;
+}
+
+void IoUring::prep_multishot_poll(int fd, uint64_t user_data) {
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = user_data;
+}
+
+void IoUring::prep_send(int fd, const void* data, size_t size, uint64_t user_data) {
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(size);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+}
+
+void IoUring::prep_cancel(uint64_t target_user_data, uint64_t user_data) {
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = target_user_data;
+    sqe->user_data = user_data;
+}
+
+bool IoUring::submit_and_wait() {
+    return enter(to_submit_, 1, IORING_ENTER_GETEVENTS);
+}
+
+bool IoUring::submit_and_poll() {
+    //With DEFER_TASKRUN nothing completes until the ring is entered, so this still enters it
+    return enter(to_submit_, 0, IORING_ENTER_GETEVENTS);
+}
+
+bool IoUring::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    while (true) {
+        enter_calls_.fetch_add(1, std::memory_order_relaxed);
+        int submitted = io_uring_enter(ring_fd_, to_submit, min_complete, flags);
+        if (submitted >= 0) {
+            to_submit_ -= static_cast<unsigned>(submitted);
+            return true;
+        }
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+}
@@ -9,6 +9,11 @@
 #include "utils.h"
 #include <ctime>
 #include <arpa/inet.h> 
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 
 namespace utils {
 
@@ -36,4 +41,69 @@ uint64_t ntohll(uint64_t value) {
     }
 }
 
-} 
\ No newline at end of file
+bool pin_current_thread(int core) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool set_realtime_priority(int priority) {
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+namespace {
+
+//Formats a CPU set as ranges, e.g. "0-3,6"
+std::string format_cpus(const cpu_set_t& cpus) {
+    std::string text;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &cpus)) {
+            continue;
+        }
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &cpus)) {
+            ++last;
+        }
+        text += (text.empty() ? "" : ",") + std::to_string(cpu);
+        if (last > cpu) {
+            text += "-" + std::to_string(last);
+        }
+        cpu = last;
+    }
+    return text;
+}
+
+}
+
+void place_current_thread(const std::string& name, int core, int fifo_priority) {
+    //Threads start together, so keep their lines whole
+    static std::mutex output_mutex;
+
+    bool pinned = core >= 0 && pin_current_thread(core);
+    bool realtime = fifo_priority > 0 && set_realtime_priority(fifo_priority);
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    int policy;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (core >= 0 && !pinned) {
+        std::cerr << "Failed to pin " << name << " to core " << core << "\n";
+    }
+    if (fifo_priority > 0 && !realtime) {
+        std::cerr << "Failed to make " << name << " SCHED_FIFO (needs CAP_SYS_NICE or RLIMIT_RTPRIO)\n";
+    }
+    std::cout << "Thread " << name << " (tid " << gettid() << "): on core " << sched_getcpu() << ", allowed "
+              << format_cpus(cpus) << ", "
+              << (policy == SCHED_FIFO ? "SCHED_FIFO priority " + std::to_string(param.sched_priority)
+                                       : std::string("SCHED_OTHER"))
+              << "\n";
+}
+
+}
@@ -0,0 +1,24 @@
+//test_check.h
+//
+//This header file holds the check() helper shared by the test programs: it
+//prints PASS or FAIL for every condition and counts the failures, so that each
+//test's main() can return non-zero when any check failed.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#ifndef TEST_CHECK_H_
+#define TEST_CHECK_H_
+
+#include <iostream>
+
+inline int failures = 0;
+
+inline void check(bool condition, const char* description) {
+    std::cout << (condition ? "PASS: " : "FAIL: ") << description << "\n";
+    if (!condition) {
+        ++failures;
+    }
+}
+
+#endif //TEST_CHECK_H_
@@ -0,0 +1,100 @@
+//test_flat_hash_map.cpp
+//
+//This file contains tests for the FlatHashMap class to ensure it behaves like
+//std::unordered_map for the operations the State class relies on.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "flat_hash_map.h"
+#include "test_check.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+void test_flat_hash_map() {
+    FlatHashMap<int64_t> map;
+    std::unordered_map<uint64_t, int64_t> reference;
+
+    //Test case 1: Boundary keys need no sentinel
+    {
+        map[0] = 7;
+        map[UINT64_MAX] = 9;
+        reference[0] = 7;
+        reference[UINT64_MAX] = 9;
+        check(map.at(0) == 7 && map.at(UINT64_MAX) == 9, "keys 0 and UINT64_MAX are stored");
+    }
+
+    //Test case 2: Random and sequential keys across several rehashes
+    {
+        std::mt19937_64 random(42);
+        for (int i = 0; i < 100000; ++i) {
+            uint64_t key = (i % 2 == 0) ? random() : static_cast<uint64_t>(i);
+            map[key] += i;
+            reference[key] += i;
+        }
+
+        bool all_found = map.size() == reference.size();
+        for (const auto& [key, value] : reference) {
+            auto it = map.find(key);
+            all_found = all_found && it != map.end() && it->second == value;
+        }
+        check(all_found, "every key matches std::unordered_map after growth");
+    }
+
+    //Test case 3: Iteration visits every entry exactly once
+    {
+        size_t visited = 0;
+        int64_t sum = 0;
+        for (const auto& [key, value] : map) {
+            ++visited;
+            sum += value;
+        }
+        int64_t expected_sum = 0;
+        for (const auto& [key, value] : reference) {
+            expected_sum += value;
+        }
+        check(visited == reference.size() && sum == expected_sum, "iteration visits every entry");
+    }
+
+    //Test case 4: Erasing half of the keys keeps the rest reachable
+    {
+        size_t erased = 0;
+        size_t index = 0;
+        for (const auto& [key, value] : reference) {
+            if (index++ % 2 == 0) {
+                erased += map.erase(key);
+            }
+        }
+        index = 0;
+        bool consistent = map.size() == reference.size() - erased;
+        for (const auto& [key, value] : reference) {
+            bool present = map.count(key) == 1;
+            consistent = consistent && (present == (index++ % 2 != 0));
+        }
+        check(consistent, "erase removes exactly the erased keys");
+        check(map.erase(12345678901234ULL) == 0, "erasing a missing key is a no-op");
+    }
+
+    //Test case 5: Missing keys and clear
+    {
+        check(map.find(12345678901234ULL) == map.end() && map.count(12345678901234ULL) == 0,
+              "missing key is not found");
+        bool threw = false;
+        try {
+            map.at(12345678901234ULL);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        check(threw, "at() throws for a missing key");
+
+        map.clear();
+        check(map.empty() && map.find(0) == map.end(), "clear removes every entry");
+    }
+}
+
+int main() {
+    test_flat_hash_map();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+//test_journal.cpp
+//
+//This file contains tests for the Journal and JournalReader classes to ensure
+//records are read back as written and a torn tail is dropped.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "journal.h"
+#include "order.h"
+#include "test_check.h"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+//Reads every intact record and returns how many there were
+size_t count_records(const std::string& path, size_t& offset) {
+    JournalReader reader;
+    if (!reader.open(path)) {
+        return 0;
+    }
+    size_t records = 0;
+    const JournalRecordHeader* record;
+    const char* payload;
+    while (reader.next(record, payload)) {
+        ++records;
+    }
+    offset = reader.offset();
+    return records;
+}
+
+}
+
+void test_journal() {
+    std::string path = "/tmp/test_journal_" + std::to_string(getpid()) + ".journal";
+    std::remove(path.c_str());
+
+    //Test case 1: A missing journal reads as empty
+    {
+        size_t offset = 0;
+        check(count_records(path, offset) == 0 && offset == 0, "missing journal is empty");
+    }
+
+    //Test case 2: Records are read back as written
+    {
+        Journal journal;
+        check(journal.open(path, 0, 0, 1, JournalSync::BATCH, 0), "journal created");
+        journal.append(0, NewOrder{NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'});
+        journal.append(0, Trade{Trade::MESSAGE_TYPE, 1, 2, 5, 100});
+        journal.append(7, DeleteOrder{DeleteOrder::MESSAGE_TYPE, 1});
+        check(journal.commit(), "batch committed");
+    }
+    {
+        JournalReader reader;
+        check(reader.open(path), "journal mapped");
+        check(reader.header() != nullptr && reader.header()->shard_count == 1, "header read back");
+
+        const JournalRecordHeader* record;
+        const char* payload;
+        check(reader.next(record, payload) && record->message_type == NewOrder::MESSAGE_TYPE, "first record is a NewOrder");
+        NewOrder new_order;
+        memcpy(&new_order, payload, sizeof(new_order));
+        check(new_order.order_id == 1 && new_order.order_qty == 10, "NewOrder payload intact");
+        check(reader.next(record, payload) && record->message_type == Trade::MESSAGE_TYPE, "second record is a Trade");
+        check(reader.next(record, payload) && record->message_type == DeleteOrder::MESSAGE_TYPE, "third record is a delete");
+        check(record->session_id == 7, "session ID read back");
+        check(!reader.next(record, payload), "no fourth record");
+    }
+
+    //Test case 3: A torn record at the end is ignored and truncated on reopen
+    size_t intact_size = 0;
+    count_records(path, intact_size);
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+        JournalRecordHeader torn = {NewOrder::MESSAGE_TYPE, sizeof(NewOrder), 0, 0};
+        check(write(fd, &torn, sizeof(torn)) == sizeof(torn), "torn record appended");
+        close(fd);
+
+        size_t offset = 0;
+        check(count_records(path, offset) == 3 && offset == intact_size, "torn record skipped");
+
+        Journal journal;
+        check(journal.open(path, offset, 0, 1, JournalSync::NONE, 0), "journal reopened");
+        journal.append(0, ModifyOrderQty{ModifyOrderQty::MESSAGE_TYPE, 1, 20});
+        check(journal.commit(), "record appended after the torn tail");
+    }
+    {
+        size_t offset = 0;
+        check(count_records(path, offset) == 4, "appended record follows the intact ones");
+    }
+
+    std::remove(path.c_str());
+}
+
+void test_failed_write() {
+    constexpr size_t INTACT_RECORDS = 1 << 16;
+    std::string path = "/tmp/test_journal_failed_" + std::to_string(getpid()) + ".journal";
+    std::remove(path.c_str());
+
+    //Test case 4: A batch that only partly fits is cut off, and the journal stays failed
+    Journal journal;
+    check(journal.open(path, 0, 0, 1, JournalSync::NONE, 0), "journal opened");
+    //The size limit below applies to every file, so the journal must outgrow this program's output
+    for (uint64_t order_id = 1; order_id <= INTACT_RECORDS; ++order_id) {
+        journal.append(0, DeleteOrder{DeleteOrder::MESSAGE_TYPE, order_id});
+    }
+    check(journal.commit(), "first batch written");
+    uint64_t intact_size = journal.size();
+    std::cout.flush();
+
+    //Past the file size limit write() stops short and then fails with EFBIG
+    signal(SIGXFSZ, SIG_IGN);
+    rlimit original;
+    getrlimit(RLIMIT_FSIZE, &original);
+    rlimit limit = original;
+    limit.rlim_cur = intact_size + sizeof(JournalRecordHeader) + 4;
+    setrlimit(RLIMIT_FSIZE, &limit);
+    for (int i = 0; i < 4; ++i) {
+        journal.append(0, NewOrder{NewOrder::MESSAGE_TYPE, 1, static_cast<uint64_t>(i), 10, 100, 'B'});
+    }
+    check(!journal.commit(), "batch past the size limit fails");
+    setrlimit(RLIMIT_FSIZE, &original);
+
+    struct stat file;
+    check(stat(path.c_str(), &file) == 0 && static_cast<uint64_t>(file.st_size) == intact_size,
+          "partly written batch is truncated away");
+    check(journal.failed(), "journal stays failed");
+    journal.append(0, DeleteOrder{DeleteOrder::MESSAGE_TYPE, 2});
+    check(!journal.commit(), "later batches are refused");
+
+    size_t offset = 0;
+    check(count_records(path, offset) == INTACT_RECORDS && offset == intact_size, "only the first batch is replayed");
+    std::remove(path.c_str());
+}
+
+int main() {
+    test_journal();
+    test_failed_write();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+//test_latency_histogram.cpp
+//
+//This file contains tests for the LatencyHistogram class to ensure values are
+//bucketed within its precision and percentiles are read back correctly.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "latency_stats.h"
+#include "test_check.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+void test_latency_histogram() {
+    //Test case 1: Small values are kept exactly
+    {
+        bool exact = true;
+        for (uint64_t value = 0; value < 64; ++value) {
+            exact = exact && LatencyHistogram::bucket_upper_bound(LatencyHistogram::bucket_for(value)) == value;
+        }
+        check(exact, "values below 64 have their own bucket");
+    }
+
+    //Test case 2: Larger values stay within the bucket precision
+    {
+        bool bounded = true;
+        for (uint64_t value = 64; value < (1ULL << 40); value = value * 3 / 2 + 7) {
+            uint64_t upper = LatencyHistogram::bucket_upper_bound(LatencyHistogram::bucket_for(value));
+            bounded = bounded && upper >= value && upper - value <= value / LatencyHistogram::SUB_BUCKETS;
+        }
+        check(bounded, "bucket upper bounds are within 1/32 of the value");
+        check(LatencyHistogram::bucket_for(UINT64_MAX) < LatencyHistogram::BUCKETS, "largest value has a bucket");
+    }
+
+    //Test case 3: Percentiles of 1..1000
+    {
+        LatencyHistogram histogram;
+        for (uint64_t value = 1; value <= 1000; ++value) {
+            histogram.record(value);
+        }
+        std::vector<uint64_t> counts(LatencyHistogram::BUCKETS);
+        uint64_t max = 0;
+        histogram.merge_into(counts, max);
+
+        uint64_t p50 = LatencyHistogram::percentile(counts, 50.0);
+        uint64_t p99 = LatencyHistogram::percentile(counts, 99.0);
+        check(p50 >= 500 && p50 <= 516, "p50 is about 500");
+        check(p99 >= 990 && p99 <= 1022, "p99 is about 990");
+        check(max == 1000, "max is exact");
+    }
+}
+
+int main() {
+    test_latency_histogram();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+//test_message_view.cpp
+//
+//This file contains tests for the in-place message views and the compile-time
+//dispatch table.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "message_view.h"
+#include "test_check.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using Handler = int (*)(const char*);
+
+template <typename Message>
+int handle(const char*) {
+    return Message::MESSAGE_TYPE * 10;
+}
+
+constexpr DispatchTable<Handler> ORDER_MESSAGES =
+    make_dispatch_table<Handler, NewOrder, DeleteOrder, ModifyOrderQty>([]<typename Message>() { return &handle<Message>; });
+
+//Built at compile time, with sizes taken from the structs
+static_assert(ORDER_MESSAGES[NewOrder::MESSAGE_TYPE].size == sizeof(NewOrder));
+static_assert(ORDER_MESSAGES[ModifyOrderQty::MESSAGE_TYPE].size == sizeof(ModifyOrderQty));
+static_assert(ORDER_MESSAGES[Trade::MESSAGE_TYPE].handler == nullptr);
+
+}
+
+void test_message_view() {
+    //Test case 1: Header fields and the message type are read in place, even unaligned
+    NewOrder new_order = {NewOrder::MESSAGE_TYPE, 7, 42, 10, 100, 'S'};
+    Header header = {1, sizeof(new_order), 1234, 0};
+    std::vector<char> buffer(1 + sizeof(header) + sizeof(new_order));
+    memcpy(buffer.data() + 1, &header, sizeof(header));
+    memcpy(buffer.data() + 1 + sizeof(header), &new_order, sizeof(new_order));
+
+    FrameView frame(buffer.data() + 1);
+    check(frame.payload_size() == sizeof(NewOrder), "The payload size is read in place");
+    check(frame.sequence_number() == 1234, "The sequence number is read in place");
+    check(frame.message_type() == NewOrder::MESSAGE_TYPE, "The message type is read in place");
+
+    //Test case 2: A message view reads fields and copies the whole message
+    MessageView<NewOrder> view(frame.payload());
+    check(view.get<uint64_t>(offsetof(NewOrder, order_id)) == 42, "A field is read through the view");
+    NewOrder copy{};
+    view.copy_to(copy);
+    check(copy.instrument_id == 7 && copy.order_qty == 10 && copy.side == 'S', "The view copies the whole message");
+
+    //Test case 3: The table dispatches listed types and rejects the others
+    const DispatchEntry<Handler>& entry = ORDER_MESSAGES[frame.message_type()];
+    check(entry.handler != nullptr && entry.handler(frame.payload()) == 10, "A listed type reaches its handler");
+    check(ORDER_MESSAGES[Logon::MESSAGE_TYPE].handler == nullptr, "An unlisted type has no handler");
+    check(ORDER_MESSAGES[0].handler == nullptr, "Type 0 has no handler");
+    check(ORDER_MESSAGES.size() == MAX_MESSAGE_TYPE + 1, "The table covers every message type");
+}
+
+int main() {
+    test_message_view();
+    return failures == 0 ? 0 : 1;
+}
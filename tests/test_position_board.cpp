@@ -0,0 +1,89 @@
+//test_position_board.cpp
+//
+//This file contains tests for the shared-memory position board: slots are
+//claimed and published by the server side and read back consistently by a
+//reader, even while a writer is updating them.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "position_board.h"
+#include "test_check.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+std::string board_name() {
+    return "risk_test_positions_" + std::to_string(getpid());
+}
+
+}
+
+void test_publish_and_read() {
+    //Test case 1: A published slot reads back; a claimed but unpublished one is skipped
+    PositionBoard board;
+    check(board.create(board_name(), 2), "The board is created");
+    PositionBoardReader reader;
+    check(reader.open(board_name()), "A reader maps the board");
+
+    PositionSlot* first = board.claim(0, 7, 100);
+    PositionSlot* second = board.claim(1, 7, 200);
+    check(first != nullptr && second != nullptr && reader.slot_count() == 2, "Slots are claimed in order");
+
+    PositionSample sample;
+    check(!reader.read(0, sample), "An unpublished slot is not read");
+    PositionBoard::publish(*first, -5, 10, 20);
+    check(reader.read(0, sample), "A published slot is read");
+    check(sample.session_id == 7 && sample.instrument_id == 100 && sample.net_position == -5 &&
+              sample.buy_qty == 10 && sample.sell_qty == 20 && sample.updates == 1,
+          "The sample holds the published counters");
+
+    PositionBoard::publish(*first, 1, 2, 3);
+    std::vector<PositionSample> samples;
+    reader.sample(samples);
+    check(samples.size() == 1 && samples[0].net_position == 1 && samples[0].updates == 2,
+          "sample() returns the latest counters of the published slots");
+
+    //Test case 2: A full board refuses new instruments and counts them
+    check(board.claim(0, 7, 300) == nullptr && reader.dropped() == 1, "A full board counts dropped instruments");
+}
+
+void test_concurrent_reads() {
+    //Test case 3: A reader never sees a half-written slot
+    PositionBoard board;
+    board.create(board_name(), 1);
+    PositionBoardReader reader;
+    reader.open(board_name());
+    PositionSlot* slot = board.claim(0, 1, 1);
+    PositionBoard::publish(*slot, 0, 0, 0);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int64_t i = 1; i <= 2'000'000; ++i) {
+            PositionBoard::publish(*slot, i, 2 * i, 3 * i);
+        }
+        done.store(true);
+    });
+
+    uint64_t torn = 0;
+    uint64_t reads = 0;
+    PositionSample sample;
+    while (!done.load()) {
+        if (reader.read(0, sample)) {
+            ++reads;
+            torn += sample.buy_qty != 2 * sample.net_position || sample.sell_qty != 3 * sample.net_position;
+        }
+    }
+    writer.join();
+    check(reads > 0 && torn == 0, "Concurrent reads are never torn");
+    check(reader.read(0, sample) && sample.net_position == 2'000'000, "The last publish is visible");
+}
+
+int main() {
+    test_publish_and_read();
+    test_concurrent_reads();
+    return failures == 0 ? 0 : 1;
+}
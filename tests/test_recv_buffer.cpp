@@ -0,0 +1,85 @@
+//test_recv_buffer.cpp
+//
+//This file contains tests for the RecvBuffer class to ensure it frames coalesced
+//and partial messages correctly.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "recv_buffer.h"
+#include "test_check.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+//Appends a framed NewOrder to the byte stream
+void append_new_order(std::vector<char>& stream, uint64_t order_id) {
+    NewOrder new_order = {NewOrder::MESSAGE_TYPE, 1, order_id, 10, 100, 'B'};
+    Header header = {1, sizeof(new_order), static_cast<uint32_t>(order_id), 0};
+    const char* header_bytes = reinterpret_cast<const char*>(&header);
+    const char* order_bytes = reinterpret_cast<const char*>(&new_order);
+    stream.insert(stream.end(), header_bytes, header_bytes + sizeof(header));
+    stream.insert(stream.end(), order_bytes, order_bytes + sizeof(new_order));
+}
+
+//Feeds the stream in chunks of chunk_size and collects the framed order IDs
+std::vector<uint64_t> feed(const std::vector<char>& stream, size_t chunk_size) {
+    RecvBuffer buffer;
+    std::vector<uint64_t> order_ids;
+    for (size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+        size_t size = std::min(chunk_size, stream.size() - offset);
+        memcpy(buffer.write_ptr(), stream.data() + offset, size);
+        buffer.commit(size);
+
+        const char* frame;
+        size_t frame_size;
+        while (buffer.next_frame(frame, frame_size) == RecvBuffer::FrameStatus::COMPLETE) {
+            NewOrder new_order;
+            memcpy(&new_order, frame + sizeof(Header), sizeof(NewOrder));
+            order_ids.push_back(new_order.order_id);
+        }
+    }
+    return order_ids;
+}
+
+}
+
+void test_recv_buffer() {
+    std::vector<char> stream;
+    for (uint64_t order_id = 1; order_id <= 100; ++order_id) {
+        append_new_order(stream, order_id);
+    }
+
+    std::vector<uint64_t> expected;
+    for (uint64_t order_id = 1; order_id <= 100; ++order_id) {
+        expected.push_back(order_id);
+    }
+
+    //Test case 1: All messages coalesced into a single read
+    check(feed(stream, stream.size()) == expected, "coalesced messages are all framed");
+
+    //Test case 2: Every message split across single-byte reads
+    check(feed(stream, 1) == expected, "byte-by-byte reads are reassembled");
+
+    //Test case 3: Reads that straddle message boundaries
+    check(feed(stream, 37) == expected, "reads straddling boundaries are reassembled");
+
+    //Test case 4: A frame larger than the buffer is reported as malformed
+    {
+        RecvBuffer buffer(64);
+        Header header = {1, 1000, 1, 0};
+        memcpy(buffer.write_ptr(), &header, sizeof(header));
+        buffer.commit(sizeof(header));
+        const char* frame;
+        size_t frame_size;
+        check(buffer.next_frame(frame, frame_size) == RecvBuffer::FrameStatus::MALFORMED,
+              "oversized frame is malformed");
+    }
+}
+
+int main() {
+    test_recv_buffer();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+//test_replay.cpp
+//
+//This file contains tests for the replay engine: reading JSON lines, wire
+//captures and journals, expanding limit ranges, and replaying one flow under
+//several configurations in parallel.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "journal.h"
+#include "replay.h"
+#include "test_check.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+std::string temp_path(const char* extension) {
+    return "/tmp/test_replay_" + std::to_string(getpid()) + extension;
+}
+
+template <typename Message>
+void append_frame(std::string& stream, const Message& message) {
+    Header header{1, sizeof(message), 0, 0};
+    stream.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.append(reinterpret_cast<const char*>(&message), sizeof(message));
+}
+
+}
+
+void test_json_lines() {
+    //Test case 1: Every message type parses, with fields in any order
+    ReplayMessage message;
+    check(parse_replay_json(R"({"type":"new","session":3,"instrument":7,"order_id":1,"qty":10,"price":100,"side":"B"})",
+                            message) &&
+              message.message_type == NewOrder::MESSAGE_TYPE && message.session_id == 3 &&
+              message.new_order.instrument_id == 7 && message.new_order.order_qty == 10 &&
+              message.new_order.order_price == 100 && message.new_order.side == 'B',
+          "A new order parses");
+    check(parse_replay_json(R"( { "order_id" : 1, "type" : "modify", "qty" : 5, "ts" : 1.5 } )", message) &&
+              message.message_type == ModifyOrderQty::MESSAGE_TYPE && message.modify_order.new_qty == 5,
+          "A modify parses with spaces and an unknown field");
+    check(parse_replay_json(R"({"type":"trade","instrument":7,"trade_id":9,"qty":-4,"price":101})", message) &&
+              message.message_type == Trade::MESSAGE_TYPE && message.trade.trade_qty == -4,
+          "A sell trade keeps its negative quantity");
+    check(parse_replay_json(R"({"type":"cancel_all","session":2})", message) &&
+              message.message_type == ReplayMessage::CANCEL_ALL && message.session_id == 2,
+          "A mass cancel parses");
+
+    //Test case 2: Malformed lines are refused
+    check(!parse_replay_json(R"({"type":"new","qty":1,"side":"X"})", message), "An unknown side is refused");
+    check(!parse_replay_json(R"({"type":"fill"})", message), "An unknown type is refused");
+    check(!parse_replay_json(R"({"type":"delete","order_id":"one"})", message), "A non-numeric ID is refused");
+    check(!parse_replay_json(R"({"type":"delete" "order_id":1})", message), "A missing comma is refused");
+    check(!parse_replay_json(R"({"type":"delete"} trailing)", message), "Trailing text is refused");
+}
+
+void test_limits_spec() {
+    //Test case 3: Single values and ranges; every combination of the ranges
+    std::vector<RiskLimits> configs;
+    check(parse_limits_spec("buy=25,sell=20", configs) && configs.size() == 1 &&
+              configs[0].max_buy_position == 25 && configs[0].max_sell_position == 20,
+          "Single values make one configuration");
+    check(format_limits(configs[0]) == "buy=25,sell=20", "Disabled limits are left out of the name");
+    configs.clear();
+    check(parse_limits_spec("buy=10:30:10,sell=5:6:1,collar=500", configs) && configs.size() == 6 &&
+              configs[5].max_buy_position == 30 && configs[5].max_sell_position == 6 &&
+              configs[5].price_collar_bps == 500,
+          "Ranges expand to every combination");
+    check(!parse_limits_spec("buy=10", configs), "Limits without sell are refused");
+    check(!parse_limits_spec("buy=10,sell=10,depth=3", configs), "An unknown key is refused");
+    check(!parse_limits_spec("buy=10:5:1,sell=10", configs), "A backwards range is refused");
+}
+
+void test_files() {
+    //Test case 4: A wire capture switches session at a Logon and skips responses
+    std::string stream;
+    append_frame(stream, NewOrder{NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'});
+    append_frame(stream, Logon{Logon::MESSAGE_TYPE, 4});
+    append_frame(stream, OrderResponse{OrderResponse::MESSAGE_TYPE, 1, OrderResponse::Status::ACCEPTED});
+    append_frame(stream, DeleteOrder{DeleteOrder::MESSAGE_TYPE, 1});
+    std::string capture = temp_path(".bin");
+    std::ofstream(capture, std::ios::binary) << stream;
+
+    std::vector<ReplayMessage> messages;
+    check(load_replay_file(capture, messages) && messages.size() == 2, "A capture is read as a wire stream");
+    check(messages[0].session_id == 0 && messages[1].session_id == 4 &&
+              messages[1].message_type == DeleteOrder::MESSAGE_TYPE,
+          "Messages after a Logon belong to its session");
+    std::remove(capture.c_str());
+
+    //Test case 5: JSON lines and journals are recognised by their first bytes
+    std::string lines = temp_path(".jsonl");
+    std::ofstream(lines) << "\n{\"type\":\"trade\",\"instrument\":1,\"qty\":5}\n\n{\"type\":\"delete\",\"order_id\":2}\n";
+    messages.clear();
+    check(load_replay_file(lines, messages) && messages.size() == 2 && messages[0].trade.trade_qty == 5,
+          "JSON lines are read, skipping blank lines");
+    std::remove(lines.c_str());
+
+    std::string journal_path = temp_path(".journal");
+    {
+        Journal journal;
+        journal.open(journal_path, 0, 0, 1, JournalSync::NONE, 0);
+        journal.append(9, Logon{Logon::MESSAGE_TYPE, 9});
+        journal.append(9, NewOrder{NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'S'});
+        journal.append(9, ReplayMessage::CANCEL_ALL, nullptr, 0);
+        journal.commit();
+    }
+    messages.clear();
+    check(load_replay_file(journal_path, messages) && messages.size() == 2 && messages[0].session_id == 9 &&
+              messages[1].message_type == ReplayMessage::CANCEL_ALL,
+          "A journal is read without its Logons");
+    std::remove(journal_path.c_str());
+}
+
+void test_replay() {
+    //Test case 6: Each configuration decides on its own; results follow the configurations
+    std::vector<ReplayMessage> messages;
+    const char* flow[] = {
+        R"({"type":"new","instrument":1,"order_id":1,"qty":10,"price":100,"side":"B"})",
+        R"({"type":"new","instrument":1,"order_id":2,"qty":10,"price":100,"side":"B"})",
+        R"({"type":"new","instrument":2,"order_id":3,"qty":30,"price":100,"side":"S"})",
+        R"({"type":"modify","order_id":1,"qty":15})",
+        R"({"type":"delete","order_id":2})",
+        R"({"type":"delete","order_id":42})",
+        R"({"type":"trade","instrument":1,"qty":10,"price":100})",
+        R"({"type":"new","session":1,"instrument":1,"order_id":1,"qty":20,"price":100,"side":"B"})",
+    };
+    for (const char* line : flow) {
+        ReplayMessage message;
+        parse_replay_json(line, message);
+        messages.push_back(message);
+    }
+
+    std::vector<RiskLimits> configs;
+    parse_limits_spec("buy=20,sell=20", configs);
+    parse_limits_spec("buy=40,sell=40", configs);
+    parse_limits_spec("buy=40,sell=40,order-qty=12", configs);
+    std::vector<ReplayResult> results = replay_all(messages, configs, 64, 3);
+
+    const ReplayResult& tight = results[0];
+    check(tight.instruments.at(1).new_accepted == 3 && tight.instruments.at(1).new_rejected == 0 &&
+              tight.instruments.at(2).new_rejected == 1,
+          "Tight limits reject the large order; sessions keep separate positions");
+    check(tight.instruments.at(1).modify_rejected == 1, "The modify that would breach is rejected");
+    check(tight.deletes == 1 && tight.unknown_orders == 1 && tight.trades == 1, "Deletes, unknown orders and trades are counted");
+
+    const ReplayResult& loose = results[1];
+    check(loose.total.new_accepted == 4 && loose.total.modify_accepted == 1, "Loose limits accept everything");
+
+    const ReplayResult& capped = results[2];
+    check(capped.total.new_accepted == 2 && capped.total.new_rejected == 2 && capped.total.modify_rejected == 1,
+          "The order size limit applies on top");
+
+    //Test case 7: Parallel results match a replay on one thread
+    std::vector<ReplayResult> single = replay_all(messages, configs, 64, 1);
+    bool same = true;
+    for (size_t i = 0; i < configs.size(); ++i) {
+        same &= single[i].total.new_accepted == results[i].total.new_accepted &&
+                single[i].total.modify_accepted == results[i].total.modify_accepted;
+    }
+    check(same, "Threads do not change the outcome");
+}
+
+int main() {
+    test_json_lines();
+    test_limits_spec();
+    test_files();
+    test_replay();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+//test_risk_checks.cpp
+//
+//This file contains tests for the pre-trade risk checks composed into State:
+//maximum order size, notional and the price collar, alongside the worst
+//position check, and the account limits kept incrementally across instruments
+//and shards.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "state.h"
+#include "test_check.h"
+#include <iostream>
+#include <thread>
+
+namespace {
+
+NewOrder buy(uint64_t order_id, uint64_t qty, uint64_t price, uint64_t instrument_id = 1) {
+    return {NewOrder::MESSAGE_TYPE, instrument_id, order_id, qty, price, 'B'};
+}
+
+Trade trade_at(uint64_t price) {
+    return {Trade::MESSAGE_TYPE, 1, 1, 0, price};
+}
+
+RiskLimits account_limits(int64_t max_account_position, int64_t max_account_notional) {
+    RiskLimits limits{1000, 1000};
+    limits.max_account_position = max_account_position;
+    limits.max_account_notional = max_account_notional;
+    return limits;
+}
+
+}
+
+void test_order_checks() {
+    //Test case 1: Maximum order size
+    {
+        State state(RiskLimits{1000, 1000, 10});
+        check(state.add_order_if_accepted(buy(1, 10, 100)), "An order at the size limit is accepted");
+        check(!state.add_order_if_accepted(buy(2, 11, 100)), "An order over the size limit is rejected");
+        check(!state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 11}),
+              "A modify over the size limit is rejected");
+    }
+
+    //Test case 2: Notional, including the resting price on a modify
+    {
+        State state(RiskLimits{1000, 1000, 0, 1000});
+        check(state.add_order_if_accepted(buy(1, 10, 100)), "An order at the notional limit is accepted");
+        check(!state.add_order_if_accepted(buy(2, 11, 100)), "An order over the notional limit is rejected");
+        check(!state.add_order_if_accepted(buy(3, 2, UINT64_MAX)), "An overflowing notional is rejected");
+        check(!state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 11}),
+              "A modify is checked at the resting order's price");
+        check(state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 5}), "A smaller modify is accepted");
+    }
+
+    //Test case 3: Price collar around the last trade
+    {
+        State state(RiskLimits{1000, 1000, 0, 0, 500});
+        check(state.add_order_if_accepted(buy(1, 1, 1)), "Any price is accepted before the first trade");
+        state.process_trade(trade_at(1000));
+        check(state.add_order_if_accepted(buy(2, 1, 1050)), "A price at the top of the collar is accepted");
+        check(state.add_order_if_accepted(buy(3, 1, 950)), "A price at the bottom of the collar is accepted");
+        check(!state.add_order_if_accepted(buy(4, 1, 1051)), "A price above the collar is rejected");
+        check(!state.add_order_if_accepted(buy(5, 1, 949)), "A price below the collar is rejected");
+        state.process_trade(trade_at(0));
+        check(!state.add_order_if_accepted(buy(6, 1, 949)), "A trade without a price keeps the reference");
+    }
+
+    //Test case 4: All checks together; the position check still applies
+    {
+        State state(RiskLimits{20, 20, 15, 10000, 1000});
+        check(state.add_order_if_accepted(buy(1, 15, 100)), "An order within every limit is accepted");
+        check(!state.add_order_if_accepted(buy(2, 6, 100)), "The worst position check still rejects");
+        check(state.add_order_if_accepted(buy(3, 5, 100)), "The order that fits every limit is accepted");
+    }
+
+    //Test case 5: Position thresholds alone leave the per-order limits off
+    {
+        State state(20, 20);
+        check(state.add_order_if_accepted(buy(1, 20, UINT64_MAX)), "The two-threshold State has no order limits");
+        BasicState<PositionRiskChecks> position_only(RiskLimits{20, 20, 1});
+        check(position_only.add_order_if_accepted(buy(1, 20, 100)), "A position-only State ignores the other limits");
+    }
+}
+
+void test_snapshot_prices() {
+    //Test case 6: The collar's reference and the resting prices survive a snapshot
+    State state(RiskLimits{1000, 1000, 0, 1000, 500});
+    state.add_order_if_accepted(buy(1, 10, 100));
+    state.process_trade(trade_at(100));
+    SnapshotSessionData snapshot;
+    state.save_snapshot(snapshot);
+
+    State restored(RiskLimits{1000, 1000, 0, 1000, 500});
+    restored.load_snapshot(snapshot.instruments.data(), snapshot.instruments.size(), snapshot.orders.data(),
+                           snapshot.orders.size());
+    check(!restored.add_order_if_accepted(buy(2, 1, 200)), "The restored state keeps the collar's reference");
+    check(!restored.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 11}),
+          "The restored order keeps its price");
+}
+
+void test_account_limits() {
+    //Test case 7: The worst positions of every instrument add up against the account limit
+    {
+        State state(account_limits(30, 0));
+        check(state.add_order_if_accepted(buy(1, 10, 1, 1)), "The first instrument takes part of the limit");
+        check(state.add_order_if_accepted(buy(2, 20, 1, 2)), "The second instrument takes the rest");
+        check(!state.add_order_if_accepted(buy(3, 1, 1, 3)), "A third instrument is over the account limit");
+        check(state.exposure_position() == 30, "The account position is the sum of the worst positions");
+        state.delete_order({DeleteOrder::MESSAGE_TYPE, 1});
+        check(state.exposure_position() == 20 && state.add_order_if_accepted(buy(3, 10, 1, 3)),
+              "A delete frees its share of the limit");
+        check(!state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 3, 11}), "A growing modify is refused");
+        check(state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 3, 5}), "A shrinking modify is accepted");
+        state.process_trade({Trade::MESSAGE_TYPE, 2, 1, -20, 1});
+        check(state.exposure_position() == 25 && state.add_order_if_accepted(buy(4, 5, 1, 4)),
+              "A trade that flattens a worst case frees exposure");
+    }
+
+    //Test case 8: Resting notional adds up across instruments and follows modifies
+    {
+        State state(account_limits(0, 1000));
+        check(state.add_order_if_accepted(buy(1, 5, 100, 1)), "An order within the notional limit is accepted");
+        check(!state.add_order_if_accepted(buy(2, 6, 100, 2)), "An order over the account notional is rejected");
+        check(state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 2}) && state.exposure_notional() == 200,
+              "A modify changes the account notional");
+        check(state.add_order_if_accepted(buy(2, 8, 100, 2)), "The freed notional can be used");
+        std::vector<uint64_t> cancelled;
+        state.cancel_all_orders(cancelled);
+        check(state.exposure_notional() == 0, "Cancelling every order clears the notional");
+    }
+
+    //Test case 9: States of one account on different shards share the limit
+    {
+        AccountExposure account;
+        {
+            State first(account_limits(100, 0), 16, &account);
+            State second(account_limits(100, 0), 16, &account);
+            check(first.add_order_if_accepted(buy(1, 60, 1, 1)), "The first shard reserves its order");
+            check(!second.add_order_if_accepted(buy(1, 50, 1, 2)), "The second shard sees the first's exposure");
+            check(second.add_order_if_accepted(buy(1, 40, 1, 2)) && account.position() == 100,
+                  "The shards fill the account limit between them");
+        }
+        check(account.position() == 0, "A destroyed State takes its share back out");
+    }
+
+    //Test case 10: Shards racing for the last of the limit never overshoot it
+    {
+        AccountExposure account;
+        State first(account_limits(5000, 0), 20000, &account);
+        State second(account_limits(5000, 0), 20000, &account);
+        int accepted[2] = {0, 0};
+        auto fill = [](State& state, int& count, uint64_t first_instrument) {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                count += state.add_order_if_accepted(buy(i + 1, 1, 1, first_instrument + i));
+            }
+        };
+        std::thread one(fill, std::ref(first), std::ref(accepted[0]), 0);
+        std::thread two(fill, std::ref(second), std::ref(accepted[1]), 1000000);
+        one.join();
+        two.join();
+        check(accepted[0] + accepted[1] == 5000 && account.position() == 5000,
+              "Concurrent shards accept exactly up to the account limit");
+    }
+}
+
+int main() {
+    test_order_checks();
+    test_snapshot_prices();
+    test_account_limits();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+//test_shard_pool.cpp
+//
+//This file contains tests for recovering a ShardPool from its journals, where the
+//shards replay one after another rather than in the order the messages arrived.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "shard_pool.h"
+#include "test_check.h"
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const RiskLimits ACCOUNT_LIMITS{1000, 1000, 0, 0, 0, 100};
+
+std::string temp_dir() {
+    return "/tmp/test_shard_pool_" + std::to_string(getpid());
+}
+
+//An instrument that the pool routes to `shard`
+uint64_t instrument_on(ShardPool& pool, size_t shard) {
+    ShardRequest request{};
+    request.message_type = Trade::MESSAGE_TYPE;
+    for (uint64_t instrument_id = 1;; ++instrument_id) {
+        size_t routed;
+        request.trade.instrument_id = instrument_id;
+        if (pool.route(request, routed) && routed == shard) {
+            return instrument_id;
+        }
+    }
+}
+
+//Submits a request from producer 0 and waits for its response
+bool submit(ShardPool& pool, ShardRequest request) {
+    size_t shard;
+    if (!pool.route(request, shard)) {
+        return false;
+    }
+    while (!pool.try_submit(0, shard, request)) {
+    }
+    bool accepted = false;
+    while (pool.drain_responses(0, [&](const ShardResponse& response) {
+               accepted = response.response.stat == OrderResponse::Status::ACCEPTED;
+           }) == 0) {
+        usleep(100);
+    }
+    return accepted;
+}
+
+ShardRequest new_order(uint64_t instrument_id, uint64_t order_id, uint64_t qty) {
+    ShardRequest request{};
+    request.message_type = NewOrder::MESSAGE_TYPE;
+    request.new_order = {NewOrder::MESSAGE_TYPE, instrument_id, order_id, qty, 100, 'B'};
+    return request;
+}
+
+ShardRequest modify_order(uint64_t order_id, uint64_t qty) {
+    ShardRequest request{};
+    request.message_type = ModifyOrderQty::MESSAGE_TYPE;
+    request.modify_order = {ModifyOrderQty::MESSAGE_TYPE, order_id, qty};
+    return request;
+}
+
+ShardRequest delete_order(uint64_t order_id) {
+    ShardRequest request{};
+    request.message_type = DeleteOrder::MESSAGE_TYPE;
+    request.delete_order = {DeleteOrder::MESSAGE_TYPE, order_id};
+    return request;
+}
+
+}
+
+void test_recovery_across_shards() {
+    std::string dir = temp_dir();
+    std::system(("rm -rf " + dir).c_str());
+
+    //Test case 1: Shard 1 takes the whole account limit and gives most of it back, then shard 0 uses it
+    {
+        ShardPool pool(2, 1, ACCOUNT_LIMITS, 64);
+        check(pool.open_journals(dir, JournalSync::NONE, 0, 0), "journals opened");
+        pool.start();
+        uint64_t instrument_a = instrument_on(pool, 1);
+        uint64_t instrument_b = instrument_on(pool, 0);
+        check(submit(pool, new_order(instrument_a, 1, 100)), "order A takes the whole account limit");
+        check(submit(pool, modify_order(1, 10)), "order A is cut down to 10");
+        check(submit(pool, new_order(instrument_b, 2, 90)), "order B takes the headroom A gave back");
+        check(!submit(pool, new_order(instrument_b, 3, 1)), "the account is full");
+        pool.stop();
+    }
+
+    //Test case 2: Shard 0 replays B before shard 1 replays A, and both are recovered
+    {
+        ShardPool pool(2, 1, ACCOUNT_LIMITS, 64);
+        check(pool.open_journals(dir, JournalSync::NONE, 0, 0), "journals replayed");
+        pool.start();
+        uint64_t instrument_b = instrument_on(pool, 0);
+        check(!submit(pool, new_order(instrument_b, 3, 1)), "the recovered account is still full");
+        check(submit(pool, modify_order(1, 5)), "order A is still resting");
+        check(submit(pool, delete_order(2)), "order B is still resting");
+        check(submit(pool, new_order(instrument_b, 4, 95)), "deleting B frees its share of the account");
+        pool.stop();
+    }
+
+    std::system(("rm -rf " + dir).c_str());
+}
+
+int main() {
+    test_recovery_across_shards();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+//test_shm_ring.cpp
+//
+//This file contains tests for the shared-memory transport: the ring, its futex
+//doorbell across threads, and claiming and releasing a gateway segment.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "shm_client.h"
+#include "shm_ring.h"
+#include "test_check.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+//Frames a NewOrder the way a gateway sends it
+std::vector<char> new_order_frame(uint64_t order_id) {
+    NewOrder new_order = {NewOrder::MESSAGE_TYPE, 1, order_id, 10, 100, 'B'};
+    Header header = {1, sizeof(new_order), static_cast<uint32_t>(order_id), 0};
+    std::vector<char> frame(sizeof(header) + sizeof(new_order));
+    memcpy(frame.data(), &header, sizeof(header));
+    memcpy(frame.data() + sizeof(header), &new_order, sizeof(new_order));
+    return frame;
+}
+
+uint64_t frame_order_id(const ShmRing::Slot& slot) {
+    NewOrder new_order;
+    memcpy(&new_order, slot.data + sizeof(Header), sizeof(NewOrder));
+    return new_order.order_id;
+}
+
+}
+
+void test_ring() {
+    auto ring = std::make_unique<ShmRing>();
+
+    //Test case 1: Messages come out in order across several wraps of the ring
+    bool in_order = true;
+    uint64_t next_pushed = 1;
+    uint64_t next_popped = 1;
+    while (next_popped <= 3 * ShmRing::SLOT_COUNT) {
+        for (int i = 0; i < 100; ++i) {
+            std::vector<char> frame = new_order_frame(next_pushed);
+            if (ring->try_push(frame.data(), frame.size())) {
+                ++next_pushed;
+            }
+        }
+        for (int i = 0; i < 70; ++i) {
+            const ShmRing::Slot* slot = ring->front();
+            if (slot == nullptr) {
+                break;
+            }
+            in_order = in_order && slot->size == sizeof(Header) + sizeof(NewOrder) &&
+                       frame_order_id(*slot) == next_popped;
+            ring->pop();
+            ++next_popped;
+        }
+    }
+    check(in_order, "Messages are popped in the order they were pushed across wraps");
+
+    //Test case 2: A full ring refuses pushes until a slot is popped
+    ring->reset();
+    std::vector<char> frame = new_order_frame(1);
+    size_t pushed = 0;
+    while (ring->try_push(frame.data(), frame.size())) {
+        ++pushed;
+    }
+    check(pushed == ShmRing::SLOT_COUNT, "A ring holds exactly SLOT_COUNT messages");
+    ring->pop();
+    check(ring->try_push(frame.data(), frame.size()), "Popping a slot makes room for one more push");
+
+    //Test case 3: A message larger than a slot is refused
+    ring->reset();
+    char large[ShmRing::SLOT_DATA + 1] = {};
+    check(!ring->try_push(large, sizeof(large)), "A message larger than a slot is refused");
+    check(ring->empty(), "A refused message leaves the ring empty");
+}
+
+void test_doorbell() {
+    //Test case 4: A consumer sleeping on the doorbell receives every message
+    auto ring = std::make_unique<ShmRing>();
+    constexpr uint64_t COUNT = 20000;
+    uint64_t received = 0;
+    bool in_order = true;
+    std::thread consumer([&ring, &received, &in_order] {
+        while (received < COUNT) {
+            const ShmRing::Slot* slot = ring->front();
+            if (slot == nullptr) {
+                ring->doorbell().wait([&ring] { return !ring->empty(); }, 1000);
+                continue;
+            }
+            in_order = in_order && frame_order_id(*slot) == received + 1;
+            ring->pop();
+            ++received;
+        }
+    });
+
+    for (uint64_t order_id = 1; order_id <= COUNT; ++order_id) {
+        std::vector<char> frame = new_order_frame(order_id);
+        while (!ring->try_push(frame.data(), frame.size())) {
+            std::this_thread::yield();
+        }
+        ring->doorbell().ring();
+        if (order_id % 1000 == 0) {
+            //Give the consumer time to fall asleep, so the wakeup path is exercised
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    consumer.join();
+    check(received == COUNT && in_order, "A futex-waiting consumer receives every message in order");
+}
+
+void test_segment() {
+    std::string name = "risk-test-" + std::to_string(getpid());
+    ShmSegment server;
+    check(server.create(name), "The server creates a gateway segment");
+    ShmGatewayLayout& layout = *server.layout();
+
+    //Test case 5: One gateway at a time
+    ShmClient first(name);
+    ShmClient second(name);
+    check(first.connect_to_server(), "A gateway claims a free segment");
+    check(layout.state.load() == ShmGatewayLayout::ATTACHED && layout.client_pid.load() == getpid(),
+          "The segment records the attached gateway");
+    check(!second.connect_to_server(), "A second gateway cannot claim a segment in use");
+
+    //Test case 6: Requests travel one frame per slot; responses come back whole
+    std::vector<char> stream;
+    for (uint64_t order_id = 1; order_id <= 3; ++order_id) {
+        std::vector<char> frame = new_order_frame(order_id);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    check(first.send_message(stream.data(), stream.size()), "A gateway sends coalesced frames");
+    bool framed = true;
+    for (uint64_t order_id = 1; order_id <= 3; ++order_id) {
+        const ShmRing::Slot* slot = layout.requests.front();
+        framed = framed && slot != nullptr && frame_order_id(*slot) == order_id;
+        layout.requests.pop();
+    }
+    check(framed && layout.requests.empty(), "Each frame lands in its own slot");
+
+    OrderResponse response = {OrderResponse::MESSAGE_TYPE, 7, OrderResponse::Status::ACCEPTED};
+    layout.responses.try_push(reinterpret_cast<const char*>(&response), sizeof(response));
+    char buffer[64];
+    OrderResponse received{};
+    bool got = first.receive_response(buffer, sizeof(buffer));
+    memcpy(&received, buffer, sizeof(received));
+    check(got && received.order_id == 7 && received.stat == OrderResponse::Status::ACCEPTED,
+          "A gateway receives the server's response");
+    check(first.receive_some(buffer, sizeof(buffer)) == 0, "receive_some returns 0 when nothing is waiting");
+
+    //Test case 7: Disconnecting hands the segment back to the server
+    first.disconnect();
+    check(layout.state.load() == ShmGatewayLayout::CLOSING, "Disconnecting marks the segment as closing");
+
+    ShmClient missing("risk-test-missing-" + std::to_string(getpid()));
+    check(!missing.connect_to_server(), "Connecting to a segment that does not exist fails");
+
+    //Test case 8: A gateway waiting for a response gives up once the server has gone
+    pid_t exited = fork();
+    if (exited == 0) {
+        _exit(0);
+    }
+    waitpid(exited, nullptr, 0);
+    layout.server_pid = exited;
+    layout.state.store(ShmGatewayLayout::FREE);
+    ShmClient orphan(name, ShmWait::FUTEX);
+    check(orphan.connect_to_server() && !orphan.receive_response(buffer, sizeof(buffer)),
+          "Waiting for a server that has exited fails instead of hanging");
+    layout.server_pid = getpid();
+}
+
+int main() {
+    test_ring();
+    test_doorbell();
+    test_segment();
+    return failures == 0 ? 0 : 1;
+}
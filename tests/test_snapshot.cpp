@@ -0,0 +1,102 @@
+//test_snapshot.cpp
+//
+//This file contains tests for State snapshots to ensure a State written to a
+//snapshot file and loaded back behaves exactly like the original.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "snapshot.h"
+#include "state.h"
+#include "test_check.h"
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+bool same_position(const State& a, const State& b, uint64_t instrument_id) {
+    State::Position first, second;
+    return a.get_position(instrument_id, first) && b.get_position(instrument_id, second) &&
+           first.net_position == second.net_position && first.buy_qty == second.buy_qty &&
+           first.sell_qty == second.sell_qty;
+}
+
+}
+
+void test_snapshot() {
+    std::string path = "/tmp/test_snapshot_" + std::to_string(getpid()) + ".snapshot";
+
+    //Build a State with resting orders and trades on two instruments
+    State original(100, 100);
+    original.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'});
+    original.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 2, 20, 100, 'S'});
+    original.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 2, 3, 30, 100, 'B'});
+    original.process_trade({Trade::MESSAGE_TYPE, 1, 4, 5, 100});
+    original.process_trade({Trade::MESSAGE_TYPE, 3, 5, -7, 100});
+
+    //A second session with its own limits and an order ID that collides with the first
+    State other(50, 60);
+    other.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 40, 100, 'B'});
+
+    //Test case 1: The snapshot is written and read back intact
+    SnapshotData data;
+    data.sessions.resize(2);
+    data.session_count = 2;
+    data.sessions[0].session_id = 0;
+    original.save_snapshot(data.sessions[0]);
+    data.sessions[1].session_id = 9;
+    other.save_snapshot(data.sessions[1]);
+    data.journal_offset = 1234;
+    check(data.sessions[0].instruments.size() == 3 && data.sessions[0].orders.size() == 3,
+          "snapshot holds every instrument and order");
+    check(write_snapshot(path, 0, 1, data), "snapshot written");
+
+    SnapshotReader reader;
+    check(reader.open(path) && reader.header() != nullptr, "snapshot mapped");
+    check(reader.header()->journal_offset == 1234, "journal offset read back");
+    check(reader.header()->session_count == 2, "session count read back");
+
+    //Test case 2: The loaded State matches the original
+    const SnapshotSession* session;
+    const SnapshotInstrument* instruments;
+    const SnapshotOrder* orders;
+    check(reader.next_session(session, instruments, orders) && session->session_id == 0, "first session read");
+    State restored(session->max_buy_position, session->max_sell_position);
+    check(restored.load_snapshot(instruments, session->instrument_count, orders, session->order_count),
+          "snapshot loaded");
+    check(same_position(original, restored, 1), "instrument 1 restored");
+    check(same_position(original, restored, 2), "instrument 2 restored");
+    check(same_position(original, restored, 3), "traded-only instrument 3 restored");
+
+    //Test case 3: Restored orders can be modified, deleted and are still unique
+    check(restored.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 1, 15}), "restored order modified");
+    check(restored.calculate_hypothetical_worst_buy_position(1) == 20, "modify applied to the restored book");
+    check(restored.delete_order({DeleteOrder::MESSAGE_TYPE, 3}), "restored order deleted");
+    check(!restored.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 2, 1, 100, 'B'}), "restored order ID still rests");
+
+    //Test case 4: A snapshot larger than the pool is refused
+    {
+        State small(100, 100, 2);
+        check(!small.load_snapshot(instruments, session->instrument_count, orders, session->order_count),
+              "snapshot larger than the pool refused");
+    }
+
+    //Test case 5: The second session keeps its own limits and book
+    check(reader.next_session(session, instruments, orders) && session->session_id == 9, "second session read");
+    check(session->max_buy_position == 50 && session->max_sell_position == 60, "session limits read back");
+    State restored_other(session->max_buy_position, session->max_sell_position);
+    check(restored_other.load_snapshot(instruments, session->instrument_count, orders, session->order_count) &&
+              same_position(other, restored_other, 1),
+          "second session restored");
+    check(!restored_other.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 5, 11, 100, 'B'}),
+          "second session checks its own limit");
+    check(!reader.next_session(session, instruments, orders), "no third session");
+
+    std::remove(path.c_str());
+}
+
+int main() {
+    test_snapshot();
+    return failures == 0 ? 0 : 1;
+}
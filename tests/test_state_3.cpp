@@ -0,0 +1,86 @@
+//test_state_3.cpp
+//
+//This file contains tests for the order-keyed operations of the State class:
+//deleting and modifying orders through the order ID index.
+//
+//Author: Nikas Zilinskis
+//Date: 17/10/2026
+
+#include "state.h"
+#include "test_check.h"
+#include <iostream>
+
+void test_scenario_3() {
+    //Initialise State with thresholds
+    State state(100, 100);
+
+    //Test case 1: Rest three orders on two instruments
+    {
+        check(state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'}), "order 1 accepted");
+        check(state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 2, 20, 100, 'B'}), "order 2 accepted");
+        check(state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 2, 3, 30, 100, 'S'}), "order 3 accepted");
+        check(!state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 2, 3, 5, 100, 'S'}), "duplicate order ID rejected");
+        check(state.find_instrument_id_by_order(3) == 2u, "order 3 found on instrument 2");
+    }
+
+    //Test case 2: Delete the first order of instrument 1
+    {
+        uint64_t instrument_id = 0;
+        check(state.delete_order({DeleteOrder::MESSAGE_TYPE, 1}, instrument_id), "order 1 deleted");
+        check(instrument_id == 1, "delete reports instrument 1");
+        check(!state.find_instrument_id_by_order(1).has_value(), "order 1 no longer indexed");
+        check(state.calculate_hypothetical_worst_buy_position(1) == 20, "buy side reduced to 20");
+        check(!state.delete_order({DeleteOrder::MESSAGE_TYPE, 1}), "second delete of order 1 rejected");
+    }
+
+    //Test case 3: Modify the remaining order of instrument 1
+    {
+        uint64_t instrument_id = 0;
+        check(state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 2, 50}, instrument_id), "order 2 modified");
+        check(instrument_id == 1, "modify reports instrument 1");
+        check(state.calculate_hypothetical_worst_buy_position(1) == 50, "buy side is 50");
+        check(!state.modify_order_if_accepted({ModifyOrderQty::MESSAGE_TYPE, 2, 150}), "modify over threshold rejected");
+        check(state.calculate_hypothetical_worst_buy_position(1) == 50, "rejected modify left buy side at 50");
+        state.print_instrument_state(1);
+    }
+
+    //Test case 4: Delete the remaining orders of both instruments
+    {
+        check(state.delete_order({DeleteOrder::MESSAGE_TYPE, 2}), "order 2 deleted");
+        check(state.delete_order({DeleteOrder::MESSAGE_TYPE, 3}), "order 3 deleted");
+        check(state.calculate_hypothetical_worst_buy_position(1) == 0, "instrument 1 is flat");
+        check(state.calculate_hypothetical_worst_sell_position(2) == 0, "instrument 2 is flat");
+    }
+
+    //Test case 5: A full order pool rejects new orders until one is freed
+    {
+        State small_state(100, 100, 2);
+        check(small_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 1, 100, 'B'}), "first order fits");
+        check(small_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 2, 1, 100, 'B'}), "second order fits");
+        check(!small_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 3, 1, 100, 'B'}), "third order rejected");
+        check(small_state.delete_order({DeleteOrder::MESSAGE_TYPE, 1}), "first order deleted");
+        check(small_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 3, 1, 100, 'B'}), "freed node reused");
+        check(small_state.calculate_hypothetical_worst_buy_position(1) == 2, "buy side is 2");
+    }
+
+    //Test case 6: A mass cancel frees every order but keeps the traded position
+    {
+        State session_state(100, 100);
+        session_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'});
+        session_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 2, 2, 20, 100, 'S'});
+        session_state.process_trade({Trade::MESSAGE_TYPE, 1, 3, 5, 100});
+
+        std::vector<uint64_t> cancelled;
+        session_state.cancel_all_orders(cancelled);
+        check(cancelled.size() == 2, "both orders cancelled");
+        check(session_state.calculate_hypothetical_worst_buy_position(1) == 5, "net position kept");
+        check(session_state.calculate_hypothetical_worst_sell_position(2) == 0, "sell side is flat");
+        check(!session_state.delete_order({DeleteOrder::MESSAGE_TYPE, 1}), "cancelled order is gone");
+        check(session_state.add_order_if_accepted({NewOrder::MESSAGE_TYPE, 1, 1, 10, 100, 'B'}), "order ID reusable");
+    }
+}
+
+int main() {
+    test_scenario_3();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+//test_trade_feed.cpp
+//
+//This file contains tests for the UDP trade feed: the SequenceTracker that
+//restores sequence order, and TradeFeed receiving datagrams over loopback.
+//
+//Author: Nikas Zilinskis
+//Date: 18/10/2026
+
+#include "sequence_tracker.h"
+#include "test_check.h"
+#include "trade_feed.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <netinet/in.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+//Offers each sequence number in turn and returns the order they were delivered in
+std::vector<uint32_t> offer(SequenceTracker& tracker, std::initializer_list<uint32_t> sequences) {
+    std::vector<uint32_t> delivered;
+    auto deliver = [&delivered](uint32_t sequence, const char*, size_t) { delivered.push_back(sequence); };
+    for (uint32_t sequence : sequences) {
+        char message[8] = {};
+        tracker.on_message(sequence, message, sizeof(message), deliver);
+    }
+    return delivered;
+}
+
+//Appends a framed Trade whose trade_id is its sequence number
+void append_trade(std::vector<char>& datagram, uint32_t sequence) {
+    Trade trade = {Trade::MESSAGE_TYPE, 1, sequence, 5, 100};
+    Header header = {1, sizeof(trade), sequence, 0};
+    const char* header_bytes = reinterpret_cast<const char*>(&header);
+    const char* trade_bytes = reinterpret_cast<const char*>(&trade);
+    datagram.insert(datagram.end(), header_bytes, header_bytes + sizeof(header));
+    datagram.insert(datagram.end(), trade_bytes, trade_bytes + sizeof(trade));
+}
+
+void send_datagram(int sender, const sockaddr_in& target, std::initializer_list<uint32_t> sequences) {
+    std::vector<char> datagram;
+    for (uint32_t sequence : sequences) {
+        append_trade(datagram, sequence);
+    }
+    sendto(sender, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+}
+
+//Waits briefly for loopback delivery, then collects the trade IDs the feed applies
+std::vector<uint64_t> receive_trades(TradeFeed& feed) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<uint64_t> trade_ids;
+    feed.receive([&trade_ids](const char* frame, size_t size) {
+        Trade trade;
+        if (size == sizeof(Header) + sizeof(Trade)) {
+            memcpy(&trade, frame + sizeof(Header), sizeof(Trade));
+            trade_ids.push_back(trade.trade_id);
+        }
+    });
+    return trade_ids;
+}
+
+int bound_port(const TradeFeed& feed) {
+    sockaddr_in addr{};
+    socklen_t size = sizeof(addr);
+    getsockname(feed.socket_fd(), reinterpret_cast<sockaddr*>(&addr), &size);
+    return ntohs(addr.sin_port);
+}
+
+}
+
+void test_sequence_tracker() {
+    //Test case 1: In-order messages are delivered straight away
+    {
+        SequenceTracker tracker(16);
+        check(offer(tracker, {5, 6, 7}) == std::vector<uint32_t>{5, 6, 7}, "The first message sets the sequence");
+        check(tracker.stats().delivered == 3 && tracker.stats().gaps == 0, "No gaps in an in-order feed");
+    }
+
+    //Test case 2: A reordered message is held until the missing one arrives
+    {
+        SequenceTracker tracker(16);
+        check(offer(tracker, {1, 3, 4}) == std::vector<uint32_t>{1}, "Messages after a gap are held");
+        check(tracker.has_gap(), "The tracker reports the open gap");
+        check(offer(tracker, {2}) == std::vector<uint32_t>{2, 3, 4}, "The missing message releases the held ones");
+        check(!tracker.has_gap() && tracker.stats().reordered == 2, "Held messages are counted as reordered");
+    }
+
+    //Test case 3: Duplicates are dropped, whether already delivered or held
+    {
+        SequenceTracker tracker(16);
+        check(offer(tracker, {1, 2, 2, 1, 4, 4}) == std::vector<uint32_t>{1, 2}, "Duplicates are not delivered");
+        check(tracker.stats().duplicates == 3, "Duplicates are counted");
+    }
+
+    //Test case 4: Giving up on a gap counts the lost messages
+    {
+        SequenceTracker tracker(16);
+        offer(tracker, {1, 4, 5});
+        std::vector<uint32_t> delivered;
+        tracker.skip_gap([&delivered](uint32_t sequence, const char*, size_t) { delivered.push_back(sequence); });
+        check(delivered == std::vector<uint32_t>{4, 5}, "Skipping a gap delivers the held messages");
+        check(tracker.stats().gaps == 1 && tracker.stats().lost == 2, "Skipped messages are counted as lost");
+        check(offer(tracker, {3}).empty() && tracker.stats().duplicates == 1, "A late message after a skip is dropped");
+    }
+
+    //Test case 5: A message beyond the window forces the gap closed
+    {
+        SequenceTracker tracker(4);
+        check(offer(tracker, {1, 3, 10}) == std::vector<uint32_t>{1, 3, 10}, "A message beyond the window skips the gap");
+        check(tracker.stats().gaps == 2 && tracker.stats().lost == 7, "Both skipped ranges are counted");
+    }
+
+    //Test case 6: Sequence numbers wrap around
+    {
+        SequenceTracker tracker(16);
+        check(offer(tracker, {0xFFFFFFFE, 0, 0xFFFFFFFF, 1}) == std::vector<uint32_t>{0xFFFFFFFE, 0xFFFFFFFF, 0, 1},
+              "Order is kept across the sequence wrap");
+    }
+}
+
+void test_unicast_feed() {
+    //Test case 7: Trades sent over loopback are applied in sequence order
+    TradeFeed feed(64);
+    check(feed.open("127.0.0.1", 0, ""), "The feed binds a unicast address");
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in target{};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(bound_port(feed));
+    inet_pton(AF_INET, "127.0.0.1", &target.sin_addr);
+
+    send_datagram(sender, target, {1, 2});
+    send_datagram(sender, target, {4});
+    check(receive_trades(feed) == std::vector<uint64_t>{1, 2}, "Several trades in one datagram are applied");
+    check(feed.has_gap(), "A missing datagram opens a gap");
+
+    send_datagram(sender, target, {3});
+    send_datagram(sender, target, {2});
+    check(receive_trades(feed) == std::vector<uint64_t>{3, 4}, "The late datagram closes the gap");
+    check(feed.stats().duplicates == 1 && feed.stats().reordered == 1 && feed.datagrams() == 4,
+          "Feed counters track reordering and duplicates");
+
+    char garbage[5] = {};
+    sendto(sender, garbage, sizeof(garbage), 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    check(receive_trades(feed).empty() && feed.malformed() == 1, "A truncated datagram is counted as malformed");
+    close(sender);
+}
+
+void test_multicast_feed() {
+    //Test case 8: Two instances joined to the same group both receive every trade
+    TradeFeed first(64);
+    TradeFeed second(64);
+    if (!first.open("239.255.0.77", 47001, "127.0.0.1") || !second.open("239.255.0.77", 47001, "127.0.0.1")) {
+        std::cout << "SKIP: multicast is not available on loopback\n";
+        return;
+    }
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr loopback{};
+    inet_pton(AF_INET, "127.0.0.1", &loopback);
+    setsockopt(sender, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+    sockaddr_in group{};
+    group.sin_family = AF_INET;
+    group.sin_port = htons(47001);
+    inet_pton(AF_INET, "239.255.0.77", &group.sin_addr);
+
+    send_datagram(sender, group, {10, 11});
+    send_datagram(sender, group, {12});
+    check(receive_trades(first) == std::vector<uint64_t>{10, 11, 12}, "The first instance receives the group's trades");
+    check(receive_trades(second) == std::vector<uint64_t>{10, 11, 12}, "The second instance receives them too");
+    close(sender);
+}
+
+int main() {
+    test_sequence_tracker();
+    test_unicast_feed();
+    test_multicast_feed();
+    return failures == 0 ? 0 : 1;
+}